@@ -0,0 +1,14 @@
+PROGRAM vecindex(input, output);
+VAR i, x, y : integer;
+VAR v : ARRAY [1 .. 4] OF integer;
+
+{ v[i] must be loaded again once i changes, even though the index folds into the subscript }
+BEGIN
+    v[1] := 10;
+    v[2] := 20;
+    i := 1;
+    x := v[i];
+    i := i + 1;
+    y := v[i];
+    writeln(x, y)
+END.
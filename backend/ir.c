@@ -0,0 +1,507 @@
+#include <string.h>
+#include <limits.h>
+#include "context.h"
+#include "ir.h"
+#include "mpascal.tab.h"
+
+/*
+***************************************************************************
+*               Internal Symbolic Constants & Global Variables
+***************************************************************************
+*/
+
+#define IR_DEFAULT_SIZE         1024
+
+/*
+***************************************************************************
+*                           Internal Routines
+***************************************************************************
+*/
+
+/* Resizes `*array` of `*size` elements of `width` bytes to hold at least `n`. */
+static void reserve (void **array, unsigned *size, unsigned n, size_t width) {
+    unsigned s = (*size == 0 ? IR_DEFAULT_SIZE : *size);
+
+    if (*array != NULL && n <= *size) {
+        return;
+    }
+    while (s < n) {
+        s *= 2;
+    }
+    if ((*array = realloc(*array, s * width)) == NULL) {
+        fprintf(stderr, "Error: ir: Couldn't resize code!\n");
+        exit(EXIT_FAILURE);
+    }
+    *size = s;
+}
+
+/* Empties the code. New code starts at the current T-Label and L-Label. */
+static void resetCode (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    code->count = code->blockCount = code->slotCount = 0;
+    code->firstTmp = ctx->t;
+    code->firstLbl = ctx->l;
+}
+
+/* Returns a corresponding C type for a given MP_<token> or TT_<token> */
+static const char *getCType (unsigned tt) {
+    switch (tt) {
+        case TT_INTEGER:    return "int";
+        case MP_INTEGER:    return "int";
+        case TT_REAL:       return "double";
+        case MP_REAL:       return "double";
+    }
+    fprintf(stderr, "Error: getCType: Unknown token-type %u!\n", tt);
+    exit(EXIT_FAILURE);
+}
+
+/* Returns a corresponding C operator for a given MP_<token> */
+static const char *getCOp (unsigned operator) {
+    switch (operator) {
+
+        // Arithmetic Operators.
+        case MP_ADDOP:      return "+";
+        case MP_SUBOP:      return "-";
+        case MP_MULOP:      return "*";
+        case MP_DIVOP:      return "/";
+        case MP_MODOP:      return "%";
+
+        // Boolean Operators.
+        case MP_RELOP_LT:   return "<";
+        case MP_RELOP_LE:   return "<=";
+        case MP_RELOP_EQ:   return "==";
+        case MP_RELOP_GE:   return ">=";
+        case MP_RELOP_GT:   return ">";
+        case MP_RELOP_NE:   return "!=";
+    }
+    fprintf(stderr, "Error: getCOp: Unknown operator %u!\n", operator);
+    exit(EXIT_FAILURE);
+}
+
+/* Prints operand `v`. Negative constants are parenthesized. Integers must fit
+ * an int. Reals are printed with six decimals, or exactly if six decimals
+ * would change their value. */
+static void printValue (CompileContext *ctx, IRValue v) {
+    FILE *fp = ctx->ir.fp;
+    char text[64];
+    long long *i;
+    double *r;
+
+    switch (v.kind) {
+        case VAL_TEMP:
+            fprintf(fp, "t%u", v.index);
+            return;
+        case VAL_VAR:
+            fprintf(fp, "%s", identifierAtIndex(ctx, v.index));
+            return;
+        case VAL_CONST:
+            if ((i = integerAtIndex(ctx, v.index)) != NULL) {
+                if (*i < INT_MIN || *i > INT_MAX) {
+                    fprintf(stderr, "Error: printValue: Integer constant %lld is out of range!\n", *i);
+                    exit(EXIT_FAILURE);
+                }
+                fprintf(fp, (*i < 0 ? "(%lld)" : "%lld"), *i);
+            } else if ((r = realAtIndex(ctx, v.index)) != NULL) {
+                snprintf(text, sizeof(text), "%f", *r);
+                if (strtod(text, NULL) != *r) {
+                    snprintf(text, sizeof(text), "%.17g", *r);
+                }
+                fprintf(fp, (*r < 0 ? "(%s)" : "%s"), text);
+            }
+            return;
+    }
+    fprintf(stderr, "Error: printValue: Unknown operand kind %u!\n", v.kind);
+    exit(EXIT_FAILURE);
+}
+
+/* Prints the readln or writeln at instruction `i`, on the arguments of the
+ * IR_PARAMs before it. */
+static void printCall (CompileContext *ctx, unsigned i) {
+    const IRInstr *in = IR_INSTR(ctx, i);
+    FILE *fp = ctx->ir.fp;
+    unsigned n, first;
+
+    // Find the first argument.
+    for (n = 0, first = i; n < in->x; ) {
+        if (IR_INSTR(ctx, --first)->kind == IR_PARAM) {
+            n++;
+        }
+    }
+
+    // Generate format string.
+    fprintf(fp, (in->kind == IR_READ ? "scanf(\"" : "printf(\""));
+    for (unsigned j = first; j < i; j++) {
+        const IRInstr *arg = IR_INSTR(ctx, j);
+        if (arg->kind != IR_PARAM) {
+            continue;
+        }
+        if (in->kind == IR_READ) {
+            fprintf(fp, "%s", (arg->a.tt == TT_INTEGER) ? "%d" : "%lf");
+        } else {
+            fprintf(fp, "%s ", (arg->a.tt == TT_INTEGER) ? "%d" : "%f");
+        }
+    }
+    fprintf(fp, (in->kind == IR_READ ? "\"," : "\\n\","));
+
+    // Generate argument list.
+    for (unsigned j = first; j < i; j++) {
+        const IRInstr *arg = IR_INSTR(ctx, j);
+        if (arg->kind != IR_PARAM) {
+            continue;
+        }
+        if (in->kind == IR_READ) {
+            fprintf(fp, "&");
+        }
+        printValue(ctx, arg->a);
+        if (--n > 0) {
+            fprintf(fp, ",");
+        }
+    }
+    fprintf(fp, ");\n");
+}
+
+/* Prints the assignment of the T-Label of instruction `in`. It is declared
+ * there, unless the T-Labels are pooled. */
+static void printDef (CompileContext *ctx, const IRInstr *in) {
+    if (ctx->code.slotCount == 0) {
+        fprintf(ctx->ir.fp, "%s ", getCType(in->tt));
+        ctx->code.declared++;
+    }
+    fprintf(ctx->ir.fp, "t%u = ", in->dst);
+}
+
+/* Prints the declarations of the pooled T-Labels, one line per token-type. */
+static void printSlots (CompileContext *ctx) {
+    static const unsigned types[] = {TT_INTEGER, TT_REAL};
+    IRCode *code = &ctx->code;
+    FILE *fp = ctx->ir.fp;
+
+    for (unsigned k = 0; k < 2; k++) {
+        const char *sep = getCType(types[k]);
+        for (unsigned s = 0; s < code->slotCount; s++) {
+            if (code->slots[s] == types[k]) {
+                fprintf(fp, "%s t%u", sep, s);
+                sep = ",";
+            }
+        }
+        if (*sep == ',') {
+            fprintf(fp, ";\n");
+        }
+    }
+    code->declared += code->slotCount;
+}
+
+/* Prints the index of vector access `in`: Its index operand, and its displacement if any. */
+static void printIndex (CompileContext *ctx, const IRInstr *in) {
+    printValue(ctx, in->a);
+    if (in->disp != 0) {
+        fprintf(ctx->ir.fp, (in->disp < 0 ? " - %d" : " + %d"), abs(in->disp));
+    }
+}
+
+/* Prints instruction `i` as a C statement. */
+static void printInstr (CompileContext *ctx, unsigned i) {
+    const IRInstr *in = IR_INSTR(ctx, i);
+    FILE *fp = ctx->ir.fp;
+
+    switch (in->kind) {
+        case IR_MOVE:
+            printDef(ctx, in);
+            printValue(ctx, in->a);
+            break;
+        case IR_UNARY:
+            printDef(ctx, in);
+            fprintf(fp, "%s", getCOp(in->op));
+            printValue(ctx, in->a);
+            break;
+        case IR_ARITH:
+            printDef(ctx, in);
+            printValue(ctx, in->a);
+            fprintf(fp, " %s ", getCOp(in->op));
+            printValue(ctx, in->b);
+            break;
+        case IR_LOAD:
+            printDef(ctx, in);
+            fprintf(fp, "%s[", identifierAtIndex(ctx, in->x));
+            printIndex(ctx, in);
+            fprintf(fp, "]");
+            break;
+        case IR_STORE:
+            fprintf(fp, "%s = ", identifierAtIndex(ctx, in->x));
+            printValue(ctx, in->a);
+            break;
+        case IR_STORE_INDEX:
+            fprintf(fp, "%s[", identifierAtIndex(ctx, in->x));
+            printIndex(ctx, in);
+            fprintf(fp, "] = ");
+            printValue(ctx, in->b);
+            break;
+        case IR_LABEL:
+            fprintf(fp, "Lab%u: ;\n", in->x);
+            return;
+        case IR_GOTO:
+            fprintf(fp, "goto Lab%u", in->x);
+            break;
+        case IR_BRANCH:
+            fprintf(fp, "if (");
+            printValue(ctx, in->a);
+            fprintf(fp, " %s ", getCOp(in->op));
+            printValue(ctx, in->b);
+            fprintf(fp, ") goto Lab%u", in->x);
+            break;
+        case IR_READ:
+        case IR_WRITE:
+            printCall(ctx, i);
+            return;
+        default:
+            return;
+    }
+    fprintf(fp, ";\n");
+}
+
+/*
+***************************************************************************
+*                                Routines
+***************************************************************************
+*/
+
+/* Empties the code for a new compilation, keeping its allocations */
+void initCode (CompileContext *ctx) {
+    resetCode(ctx);
+    ctx->code.built = ctx->code.emitted = ctx->code.declared = 0;
+}
+
+/* Returns a T-Label operand of token-type `tt` */
+IRValue tempValue (unsigned tt, unsigned t) {
+    return (IRValue){.kind = VAL_TEMP, .tt = tt, .index = t};
+}
+
+/* Returns a variable operand of token-type `tt` */
+IRValue varValue (unsigned tt, unsigned id) {
+    return (IRValue){.kind = VAL_VAR, .tt = tt, .index = id};
+}
+
+/* Returns a constant operand for value-index `vi` */
+IRValue constValue (CompileContext *ctx, unsigned vi) {
+    unsigned tt = (integerAtIndex(ctx, vi) != NULL ? TT_INTEGER : TT_REAL);
+    return (IRValue){.kind = VAL_CONST, .tt = tt, .index = vi};
+}
+
+/* Appends a pooled T-Label slot of token-type `tt`. Returns its T-Label */
+unsigned addSlot (CompileContext *ctx, unsigned tt) {
+    IRCode *code = &ctx->code;
+
+    reserve((void **)&code->slots, &code->slotSize, code->slotCount + 1, sizeof(unsigned char));
+    code->slots[code->slotCount] = tt;
+    return code->slotCount++;
+}
+
+/* Appends an instruction. Returns its index */
+unsigned addInstr (CompileContext *ctx, unsigned kind, unsigned tt, unsigned op, unsigned dst, unsigned x, IRValue a, IRValue b) {
+    IRCode *code = &ctx->code;
+
+    reserve((void **)&code->instrs, &code->size, code->count + 1, sizeof(IRInstr));
+    code->instrs[code->count] = (IRInstr){.kind = kind, .tt = tt, .op = op, .dst = dst, .x = x, .a = a, .b = b};
+    code->built++;
+    return code->count++;
+}
+
+/* Returns nonzero if instruction `in` assigns a T-Label, and has no other effect */
+int isPure (const IRInstr *in) {
+    return (in->kind == IR_MOVE || in->kind == IR_UNARY || in->kind == IR_ARITH || in->kind == IR_LOAD);
+}
+
+/* Splits the code into basic blocks and links them. IR_NOPs are dropped */
+void buildBlocks (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    unsigned n = 0, labels = ctx->l - code->firstLbl, b, s;
+    IRBlock *block;
+
+    // (1). Drop removed instructions.
+    for (unsigned i = 0; i < code->count; i++) {
+        if (code->instrs[i].kind != IR_NOP) {
+            code->instrs[n++] = code->instrs[i];
+        }
+    }
+    code->count = n;
+
+    // (2). Split into blocks at labels, and after jumps.
+    code->blockCount = 0;
+    reserve((void **)&code->labels, &code->labelSize, labels, sizeof(unsigned));
+    memset(code->labels, 0xff, labels * sizeof(unsigned));
+    for (unsigned i = 0; i < code->count; i++) {
+        const IRInstr *in = &code->instrs[i];
+        if (i == 0 || in->kind == IR_LABEL || in[-1].kind == IR_GOTO || in[-1].kind == IR_BRANCH) {
+            reserve((void **)&code->blocks, &code->blockSize, code->blockCount + 1, sizeof(IRBlock));
+            block = &code->blocks[code->blockCount++];
+            *block = (IRBlock){.first = i, .label = NIL, .succ = {NIL, NIL}, .preds = 0};
+            if (in->kind == IR_LABEL) {
+                block->label = in->x;
+                code->labels[in->x - code->firstLbl] = code->blockCount - 1;
+            }
+        }
+        block->last = i + 1;
+    }
+
+    // (3). Link each block to its successors, counting predecessors.
+    for (b = 0; b < code->blockCount; b++) {
+        const IRInstr *in = &code->instrs[code->blocks[b].last - 1];
+        block = &code->blocks[b];
+        if (in->kind != IR_GOTO && b + 1 < code->blockCount) {
+            block->succ[0] = b + 1;
+        }
+        if ((in->kind == IR_GOTO || in->kind == IR_BRANCH) && (s = blockOfLabel(ctx, in->x)) != block->succ[0]) {
+            block->succ[1] = s;
+        }
+        for (int k = 0; k < 2; k++) {
+            if (block->succ[k] != NIL) {
+                code->blocks[block->succ[k]].preds++;
+            }
+        }
+    }
+
+    // (4). Lay out the predecessor lists.
+    n = 0;
+    for (b = 0; b < code->blockCount; b++) {
+        code->blocks[b].pred = n;
+        n += code->blocks[b].preds;
+        code->blocks[b].preds = 0;
+    }
+    reserve((void **)&code->preds, &code->predSize, n, sizeof(unsigned));
+    for (b = 0; b < code->blockCount; b++) {
+        for (int k = 0; k < 2; k++) {
+            if ((s = code->blocks[b].succ[k]) != NIL) {
+                block = &code->blocks[s];
+                code->preds[block->pred + block->preds++] = b;
+            }
+        }
+    }
+}
+
+/* Returns the block of L-Label `l`, or NIL if it is not in the code */
+unsigned blockOfLabel (CompileContext *ctx, unsigned l) {
+    IRCode *code = &ctx->code;
+    if (l < code->firstLbl || l >= ctx->l) {
+        return NIL;
+    }
+    return code->labels[l - code->firstLbl];
+}
+
+/* Finds the immediate dominator of each block: The last block through which
+ * every path from the first block passes. It is NIL for the first block, and
+ * for blocks that can't be reached. Valid until the blocks are rebuilt */
+void findDominators (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    unsigned n = code->blockCount, *order, *number, *stack, *next, top = 0, count = 0, b, s, d;
+    int changed;
+
+    if (n == 0) {
+        return;
+    }
+    order = calloc(n, sizeof(unsigned));
+    number = calloc(n, sizeof(unsigned));
+    stack = calloc(n, sizeof(unsigned));
+    next = calloc(n, sizeof(unsigned));
+    if (order == NULL || number == NULL || stack == NULL || next == NULL) {
+        fprintf(stderr, "Error: findDominators: Couldn't allocate block orders!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // (1). Number the blocks in postorder (unreachable ones stay unnumbered).
+    for (b = 0; b < n; b++) {
+        code->blocks[b].idom = NIL;
+        number[b] = NIL;
+    }
+    number[0] = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        b = stack[top - 1];
+        if (next[b] < 2) {
+            if ((s = code->blocks[b].succ[next[b]++]) != NIL && number[s] == NIL) {
+                number[s] = 0;
+                stack[top++] = s;
+            }
+            continue;
+        }
+        number[b] = count;
+        order[count++] = b;
+        top--;
+    }
+
+    // (2). Intersect the dominators of the predecessors, in reverse postorder.
+    code->blocks[0].idom = 0;
+    do {
+        changed = 0;
+        for (unsigned k = count - 1; k-- > 0; ) {
+            IRBlock *block = &code->blocks[order[k]];
+            d = NIL;
+            for (unsigned p = 0; p < block->preds; p++) {
+                if ((b = code->preds[block->pred + p]) == NIL || code->blocks[b].idom == NIL) {
+                    continue;
+                }
+                if (d == NIL) {
+                    d = b;
+                    continue;
+                }
+                while (b != d) {
+                    while (number[b] < number[d]) {
+                        b = code->blocks[b].idom;
+                    }
+                    while (number[d] < number[b]) {
+                        d = code->blocks[d].idom;
+                    }
+                }
+            }
+            if (block->idom != d) {
+                block->idom = d;
+                changed = 1;
+            }
+        }
+    } while (changed);
+    code->blocks[0].idom = NIL;
+    free(order);
+    free(number);
+    free(stack);
+    free(next);
+}
+
+/* Returns nonzero if block `a` dominates block `b`. Dominators must be found */
+int dominates (CompileContext *ctx, unsigned a, unsigned b) {
+    while (b != NIL && b != a) {
+        b = ctx->code.blocks[b].idom;
+    }
+    return (b == a);
+}
+
+/* Writes the code as C to the IR buffer and empties it. Pooled T-Labels are
+ * declared in a block around the code. New code starts at the current T-Label
+ * and L-Label */
+void emitCode (CompileContext *ctx) {
+    int pooled = (ctx->code.slotCount > 0);
+
+    if (pooled) {
+        fprintf(ctx->ir.fp, "{\n");
+        printSlots(ctx);
+    }
+    for (unsigned i = 0; i < ctx->code.count; i++) {
+        if (IR_INSTR(ctx, i)->kind != IR_NOP) {
+            printInstr(ctx, i);
+            ctx->code.emitted++;
+        }
+    }
+    if (pooled) {
+        fprintf(ctx->ir.fp, "}\n");
+    }
+    resetCode(ctx);
+}
+
+/* Frees the code */
+void freeCode (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    free(code->instrs);
+    free(code->blocks);
+    free(code->preds);
+    free(code->labels);
+    free(code->slots);
+    memset(code, 0, sizeof(IRCode));
+}
@@ -0,0 +1,169 @@
+#if !defined(IR_H)
+#define IR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mptypes.h"
+
+/*
+***************************************************************************
+*                       Three-Address Intermediate Code                   *
+* AUTHORS: Charles Randolph, Joe Jones.                                   *
+* SNUMBERS: s2897318, s2990652.                                           *
+***************************************************************************
+*/
+
+/*
+ * The code generator (irgen.c) builds the main program as three-address code
+ * in memory: One instruction per C statement it used to print, on the same
+ * T-Labels (tN) and L-Labels (LabN). The optimizer (passes.h) then rewrites
+ * the code, and the emitter prints it as C.
+ *
+ * Each T-Label is assigned by exactly one instruction, which also gives its
+ * token-type. Operands are T-Labels, variables or constants of the number
+ * table. Removed instructions become IR_NOP until the blocks are rebuilt.
+ *
+ * Code is a list of basic blocks. A block starts at a label or after a jump,
+ * and ends in a jump or before a label. Its successors are the next block
+ * (unless it ends in a goto) and the target of its jump, if any.
+ *
+ * From -O1, the last pass pools the T-Labels (see passes.c): T-Labels whose
+ * values are never needed at the same time share a slot, and are renamed to
+ * it. The slots are declared at the top of a C block around the code.
+ */
+
+/*
+***************************************************************************
+*                            Type Definitions
+***************************************************************************
+*/
+
+// Instructions. Operands `a` and `b`, the result `dst` and `x` are given alongside.
+typedef enum {
+    IR_NOP,                 // Removed instruction.
+    IR_MOVE,                // dst = a.
+    IR_UNARY,               // dst = op a.
+    IR_ARITH,               // dst = a op b.
+    IR_LOAD,                // dst = x[a + disp], for vector x.
+    IR_STORE,               // x = a.
+    IR_STORE_INDEX,         // x[a + disp] = b.
+    IR_LABEL,               // Label Lab<x>.
+    IR_GOTO,                // goto Lab<x>.
+    IR_BRANCH,              // if (a op b) goto Lab<x>.
+    IR_PARAM,               // Argument a of the next IR_READ or IR_WRITE.
+    IR_READ,                // readln of the x preceding IR_PARAMs (variables).
+    IR_WRITE                // writeln of the x preceding IR_PARAMs.
+} IRKind;
+
+// Operand kinds.
+typedef enum {
+    VAL_NONE,               // No operand.
+    VAL_TEMP,               // T-Label.
+    VAL_VAR,                // Variable, by identifier-index.
+    VAL_CONST               // Constant, by value-index.
+} IRValueKind;
+
+// An operand.
+typedef struct {
+    unsigned char kind;     // Operand kind (VAL_<kind>).
+    unsigned char tt;       // Token-type.
+    unsigned index;         // T-Label, identifier-index or value-index.
+} IRValue;
+
+// An instruction.
+typedef struct {
+    unsigned char kind;     // Instruction (IR_<kind>).
+    unsigned char tt;       // Token-type of the result, or of the value stored.
+    unsigned short op;      // Operator (MP_<token>) of IR_UNARY, IR_ARITH and IR_BRANCH.
+    unsigned dst;           // T-Label assigned, if any.
+    unsigned x;             // Variable, L-Label or argument count (see IRKind).
+    IRValue a, b;           // Operands.
+    int disp;               // Displacement added to the index of IR_LOAD and IR_STORE_INDEX.
+} IRInstr;
+
+// A basic block.
+typedef struct {
+    unsigned first, last;   // Instructions [first, last).
+    unsigned label;         // L-Label of the block, or NIL.
+    unsigned succ[2];       // Next block and jump target, or NIL.
+    unsigned pred, preds;   // Predecessors: `preds` blocks from `pred` in the predecessor list.
+    unsigned idom;          // Immediate dominator, once found (see findDominators), or NIL.
+} IRBlock;
+
+// Code of the main program, or of the statement being generated in incremental mode.
+typedef struct {
+    IRInstr *instrs;        // Instructions.
+    unsigned count, size;   // Instructions in use, and allocated.
+    IRBlock *blocks;        // Basic blocks, in order.
+    unsigned blockCount, blockSize;
+    unsigned *preds;        // Predecessor list of all blocks.
+    unsigned predSize;
+    unsigned *labels;       // Block of each L-Label, from `firstLbl` (NIL if none).
+    unsigned labelSize;
+    unsigned firstTmp;      // First T-Label of the code.
+    unsigned firstLbl;      // First L-Label of the code.
+    unsigned char *slots;   // Token-type of each pooled T-Label, once pooled.
+    unsigned slotCount, slotSize;
+    unsigned built;         // Instructions built over the compilation.
+    unsigned emitted;       // Instructions emitted over the compilation.
+    unsigned declared;      // T-Labels declared over the compilation.
+} IRCode;
+
+/* The context of a compilation (see context.h) */
+typedef struct compileContext CompileContext;
+
+// Returns the instruction at index `i` of the code of `ctx`. Valid until the next one is added.
+#define IR_INSTR(ctx, i)    (&(ctx)->code.instrs[(i)])
+
+// Returns the block at index `b` of the code of `ctx`.
+#define IR_BLOCK(ctx, b)    (&(ctx)->code.blocks[(b)])
+
+/*
+***************************************************************************
+*                           Routine Prototypes
+***************************************************************************
+*/
+
+/* Empties the code for a new compilation, keeping its allocations */
+void initCode (CompileContext *ctx);
+
+/* Returns a T-Label operand of token-type `tt` */
+IRValue tempValue (unsigned tt, unsigned t);
+
+/* Returns a variable operand of token-type `tt` */
+IRValue varValue (unsigned tt, unsigned id);
+
+/* Returns a constant operand for value-index `vi` */
+IRValue constValue (CompileContext *ctx, unsigned vi);
+
+/* Appends a pooled T-Label slot of token-type `tt`. Returns its T-Label */
+unsigned addSlot (CompileContext *ctx, unsigned tt);
+
+/* Appends an instruction. Returns its index */
+unsigned addInstr (CompileContext *ctx, unsigned kind, unsigned tt, unsigned op, unsigned dst, unsigned x, IRValue a, IRValue b);
+
+/* Returns nonzero if instruction `in` assigns a T-Label, and has no other effect */
+int isPure (const IRInstr *in);
+
+/* Splits the code into basic blocks and links them. IR_NOPs are dropped */
+void buildBlocks (CompileContext *ctx);
+
+/* Returns the block of L-Label `l`, or NIL if it is not in the code */
+unsigned blockOfLabel (CompileContext *ctx, unsigned l);
+
+/* Finds the immediate dominator of each block: The last block through which
+ * every path from the first block passes. It is NIL for the first block, and
+ * for blocks that can't be reached. Valid until the blocks are rebuilt */
+void findDominators (CompileContext *ctx);
+
+/* Returns nonzero if block `a` dominates block `b`. Dominators must be found */
+int dominates (CompileContext *ctx, unsigned a, unsigned b);
+
+/* Writes the code as C to the IR buffer and empties it. New code starts at
+ * the current T-Label and L-Label */
+void emitCode (CompileContext *ctx);
+
+/* Frees the code */
+void freeCode (CompileContext *ctx);
+
+#endif
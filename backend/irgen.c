@@ -1,4 +1,6 @@
+#include "context.h"
 #include "irgen.h"
+#include "passes.h"
 
 /*
 ***************************************************************************
@@ -6,11 +8,10 @@
 ***************************************************************************
 */
 
-/* Counter for T-labels (temporary labels for expression operands) */
-static unsigned t;
-
-/* Counter for L-labels (labels for control-flow like loops) */
-static unsigned l;
+/* The T-Label and L-Label counters of a compilation are kept in its context:
+ * ctx->t counts temporaries for expression operands, ctx->l labels for
+ * control-flow like loops. Code is built as three-address instructions in
+ * ctx->code (see ir.h), and written out as C by flushCode. */
 
 /*
 ***************************************************************************
@@ -18,53 +19,39 @@ static unsigned l;
 ***************************************************************************
 */
 
-/* Returns a corresponding C type for a given MP_<token> or TT_<token> */
-static const char *getCType (unsigned tt) {
-    switch (tt) {
-        case TT_INTEGER:    return "int";
-        case MP_INTEGER:    return "int";
-        case TT_REAL:       return "double";
-        case MP_REAL:       return "double";
+/* Returns the inverse of the given MP_<token> relational operator */
+static unsigned invOp (unsigned operator) {
+    switch (operator) {
+        case MP_RELOP_LT:   return MP_RELOP_GE;
+        case MP_RELOP_LE:   return MP_RELOP_GT;
+        case MP_RELOP_EQ:   return MP_RELOP_NE;
+        case MP_RELOP_GE:   return MP_RELOP_LT;
+        case MP_RELOP_GT:   return MP_RELOP_LE;
+        case MP_RELOP_NE:   return MP_RELOP_EQ;
     }
-    fprintf(stderr, "Error: getCType: Unknown token-type %u!\n", tt);
+    fprintf(stderr, "Error: invOp: Unknown operator %u!\n", operator);
     exit(EXIT_FAILURE);
 }
 
-/* Returns a corresponding C operator for a given MP_<token> */
-static const char *getCOp (unsigned operator) {
-    switch (operator) {
+/* Returns no operand */
+static IRValue noValue (void) {
+    return (IRValue){.kind = VAL_NONE, .tt = UNDEFINED, .index = 0};
+}
 
-        // Arithmetic Operators.
-        case MP_ADDOP:      return "+";
-        case MP_SUBOP:      return "-";
-        case MP_MULOP:      return "*";
-        case MP_DIVOP:      return "/";
-        case MP_MODOP:      return "%";
-
-        // Boolean Operators.
-        case MP_RELOP_LT:   return "<";
-        case MP_RELOP_LE:   return "<=";
-        case MP_RELOP_EQ:   return "==";
-        case MP_RELOP_GE:   return ">=";
-        case MP_RELOP_GT:   return ">";
-        case MP_RELOP_NE:   return "!=";
-    }
-    fprintf(stderr, "Error: getCOp: Unknown operator %u!\n", operator);
-    exit(EXIT_FAILURE);
+/* Returns the operand T-Label `t` of integer token-type */
+static IRValue intTemp (unsigned t) {
+    return tempValue(TT_INTEGER, t);
 }
 
-/* Returns a inverted C operator for the given MP_<token> operator */
-static const char *invOp (unsigned operator) {
-    switch (operator) {
-        case MP_RELOP_LT:   return ">=";
-        case MP_RELOP_LE:   return ">";
-        case MP_RELOP_EQ:   return "!=";
-        case MP_RELOP_GE:   return "<";
-        case MP_RELOP_GT:   return "<=";
-        case MP_RELOP_NE:   return "==";
-    }
-    fprintf(stderr, "Error: invOp: Unknown operator %u!\n", operator);
-    exit(EXIT_FAILURE);
+/* Returns the integer constant `n` as an operand */
+static IRValue intConst (CompileContext *ctx, long long n) {
+    return constValue(ctx, installInteger(ctx, n));
+}
+
+/* Generates a T-Label holding index `ti` less lower bound `vb`. Returns T-Label num. */
+static unsigned genOffset (CompileContext *ctx, unsigned ti, unsigned vb) {
+    addInstr(ctx, IR_ARITH, TT_INTEGER, MP_SUBOP, ctx->t, NIL, intTemp(ti), intConst(ctx, vb));
+    return ctx->t++;
 }
 
 /*
@@ -73,46 +60,81 @@ static const char *invOp (unsigned operator) {
 ***************************************************************************
 */
 
-/* Generates a T-Label for given constant of type `tt`. Returns T-Label num */
-unsigned genConst (unsigned tt, double n) {
-    if (tt == TT_REAL) {
-        fprintf(irfp, "double t%u = %f;\n", t, n);
-    } else {
-        fprintf(irfp, "int t%u = %d;\n", t, (int)n);
-    }
-    return t++;
+/* Generates a T-Label for the constant at value-index `vi`. Returns T-Label num */
+unsigned genConst (CompileContext *ctx, unsigned vi) {
+    IRValue n = constValue(ctx, vi);
+    addInstr(ctx, IR_MOVE, n.tt, UNDEFINED, ctx->t, NIL, n, noValue());
+    return ctx->t++;
 }
 
 /* Generates a T-Label for given identifier. Returns T-Label num */
-unsigned genId (unsigned tt, const char *identifier) {
-    fprintf(irfp, "%s t%u = %s;\n", getCType(tt), t, identifier);
-    return t++;
+unsigned genId (CompileContext *ctx, unsigned tt, unsigned id) {
+    addInstr(ctx, IR_MOVE, tt, UNDEFINED, ctx->t, NIL, varValue(tt, id), noValue());
+    return ctx->t++;
 }
 
 /* Generates a T-Label for an T-indexed vector. Returns T-Label num. */
-unsigned genVecIdx (unsigned tt, const char *identifier, unsigned ti, unsigned vb) {
-    unsigned adjustedTi = t;
-    fprintf(irfp, "int t%u = t%u - %u;\n", t++, ti, vb);
-    fprintf(irfp, "%s t%u = %s[t%u];\n", getCType(tt), t, identifier, adjustedTi);
-    return t++;
+unsigned genVecIdx (CompileContext *ctx, unsigned tt, unsigned id, unsigned ti, unsigned vb) {
+    unsigned adjustedTi = genOffset(ctx, ti, vb);
+    addInstr(ctx, IR_LOAD, tt, UNDEFINED, ctx->t, id, intTemp(adjustedTi), noValue());
+    return ctx->t++;
 }
 
 /* Generates a T-Label for a unary operation (-|+) ti. Returns T-Label num. */
-unsigned genUnaryOp (unsigned tt, unsigned operator, unsigned ti) {
-    fprintf(irfp, "%s t%u = %st%u;\n", getCType(tt), t, getCOp(operator), ti);
-    return t++;
+unsigned genUnaryOp (CompileContext *ctx, unsigned tt, unsigned operator, unsigned ti) {
+    addInstr(ctx, IR_UNARY, tt, operator, ctx->t, NIL, tempValue(tt, ti), noValue());
+    return ctx->t++;
+}
+
+/* Generates a T-Label for arithmetic operation. (tx op ty). Returns T-Label num.
+ * The operands are of token-types `ttx` and `tty`. */
+unsigned genArithOp (CompileContext *ctx, unsigned tt, unsigned operator, unsigned ttx, unsigned tx, unsigned tty, unsigned ty) {
+    addInstr(ctx, IR_ARITH, tt, operator, ctx->t, NIL, tempValue(ttx, tx), tempValue(tty, ty));
+    return ctx->t++;
 }
 
-/* Generates a T-Label for arithmetic operation. (tx op ty). Returns T-Label num. */
-unsigned genArithOp (unsigned tt, unsigned operator, unsigned tx, unsigned ty) {
-    fprintf(irfp, "%s t%u = t%u %s t%u;\n", getCType(tt), t, tx, getCOp(operator), ty);
-    return t++;
+/* Generates a T-Label for a boolean operation (tx - ty). Returns T-Label num.
+ * The operands are of token-types `ttx` and `tty`. */
+unsigned genBoolOp (CompileContext *ctx, unsigned tt, unsigned ttx, unsigned tx, unsigned tty, unsigned ty) {
+    addInstr(ctx, IR_ARITH, tt, MP_SUBOP, ctx->t, NIL, tempValue(ttx, tx), tempValue(tty, ty));
+    return ctx->t++;
 }
 
-/* Generates a T-Label for a boolean operation (tx - ty). Returns T-Label num. */
-unsigned genBoolOp (unsigned tx, unsigned ty) {
-    fprintf(irfp, "int t%u = t%u - t%u;\n", t, tx, ty);
-    return t++;
+/* Generates the expression at node `n` of the syntax tree. Returns the T-Label of its value */
+static unsigned genExpression (CompileContext *ctx, unsigned n) {
+    const AstNode *node = AST_NODE(ctx, n);
+    unsigned tx, ty;
+
+    switch (node->kind) {
+        case AST_CONST:
+            return genConst(ctx, node->vi);
+
+        case AST_ID:
+            return genId(ctx, node->tt, node->a);
+
+        case AST_INDEX:
+            tx = genExpression(ctx, node->b);
+            return genVecIdx(ctx, node->tt, node->a, tx, node->c);
+
+        // The sign is applied in the token-type of the operand.
+        case AST_UNARY:
+            tx = genExpression(ctx, node->a);
+            return genUnaryOp(ctx, AST_NODE(ctx, node->a)->tt, node->op, tx);
+
+        // Type promotion is illogical for modulo. Result is always generated as integer.
+        case AST_BINARY:
+            tx = genExpression(ctx, node->a);
+            ty = genExpression(ctx, node->b);
+            return genArithOp(ctx, (node->op == MP_MODOP) ? TT_INTEGER : node->tt, node->op,
+                AST_NODE(ctx, node->a)->tt, tx, AST_NODE(ctx, node->b)->tt, ty);
+
+        case AST_COMPARE:
+            tx = genExpression(ctx, node->a);
+            ty = genExpression(ctx, node->b);
+            return genBoolOp(ctx, TT_INTEGER, AST_NODE(ctx, node->a)->tt, tx, AST_NODE(ctx, node->b)->tt, ty);
+    }
+    fprintf(stderr, "Error: genExpression: Unknown node kind %u!\n", node->kind);
+    exit(EXIT_FAILURE);
 }
 
 /*
@@ -121,16 +143,15 @@ unsigned genBoolOp (unsigned tx, unsigned ty) {
 ***************************************************************************
 */
 
-/* Generates a T-Label for a scalar assignment. */
-void genScalarAssignment (const char *identifier, unsigned ti) {
-    fprintf(irfp, "%s = t%u;\n", identifier, ti);
+/* Generates a scalar assignment of T-Label ti, of token-type tt. */
+void genScalarAssignment (CompileContext *ctx, unsigned tt, unsigned id, unsigned ti) {
+    addInstr(ctx, IR_STORE, tt, UNDEFINED, NIL, id, tempValue(tt, ti), noValue());
 }
 
-/* Generates a T-Label for a vector-index assignment. */
-void genVectorAssignment (const char *identifier, unsigned ti, unsigned vb, unsigned te) {
-    unsigned adjustedTi = t;
-    fprintf(irfp, "int t%u = t%u - %u;\n", t++, ti, vb);
-    fprintf(irfp, "%s[t%u] = t%u;\n", identifier, adjustedTi, te);
+/* Generates a vector-index assignment of T-Label te, of token-type tt. */
+void genVectorAssignment (CompileContext *ctx, unsigned tt, unsigned id, unsigned ti, unsigned vb, unsigned te) {
+    unsigned adjustedTi = genOffset(ctx, ti, vb);
+    addInstr(ctx, IR_STORE_INDEX, tt, UNDEFINED, NIL, id, intTemp(adjustedTi), tempValue(tt, te));
 }
 
 /*
@@ -139,36 +160,48 @@ void genVectorAssignment (const char *identifier, unsigned ti, unsigned vb, unsi
 ***************************************************************************
 */
 
+/* Resets the T-Label and L-Label counters for a new compilation. */
+void resetLabels (CompileContext *ctx) {
+    ctx->t = ctx->l = 0;
+}
+
 /* Returns the current label */
-unsigned getLbl() {
-    return l;
+unsigned getLbl (CompileContext *ctx) {
+    return ctx->l;
+}
+
+/* Returns the current T-Label */
+unsigned getTmp (CompileContext *ctx) {
+    return ctx->t;
 }
 
 /* Generates a L-Label. Returns L-Label num. */
-unsigned genLbl() {
-    fprintf(irfp, "Lab%u: ;\n", l);
-    return l++;
+unsigned genLbl (CompileContext *ctx) {
+    addInstr(ctx, IR_LABEL, UNDEFINED, UNDEFINED, NIL, ctx->l, noValue(), noValue());
+    return ctx->l++;
 }
 
 /* Generates a L-Label at given number. Returns L-Label num. */
-unsigned genLblAt (unsigned l) {
-    fprintf(irfp, "Lab%u: ;\n", l);
+unsigned genLblAt (CompileContext *ctx, unsigned l) {
+    addInstr(ctx, IR_LABEL, UNDEFINED, UNDEFINED, NIL, l, noValue(), noValue());
     return l;
 }
 
 /* Reserves the next n L-Labels. */
-void reserveLbl (unsigned n) {
-    l += n;
+void reserveLbl (CompileContext *ctx, unsigned n) {
+    ctx->l += n;
 }
 
-/* Generates a GOTO conditional statement with destination L-Label */
-void genGoto (unsigned l) {
-    fprintf(irfp, "goto Lab%u;\n", l);
+/* Generates a GOTO statement with destination L-Label */
+void genGoto (CompileContext *ctx, unsigned l) {
+    addInstr(ctx, IR_GOTO, UNDEFINED, UNDEFINED, NIL, l, noValue(), noValue());
 }
 
-/* Generates a conditional statement (inverts op). Does not print newline. */
-void genIf (unsigned ti, unsigned op) {
-    fprintf(irfp, "if (t%u %s 0) ", ti, invOp(op));
+/* Generates a conditional jump to L-Label l, taken if the guard ti is false
+ * (inverts op). Guards without a comparison operator are treated as (ti <> 0). */
+void genIf (CompileContext *ctx, unsigned ti, unsigned op, unsigned l) {
+    op = invOp(op == UNDEFINED ? MP_RELOP_NE : op);
+    addInstr(ctx, IR_BRANCH, TT_INTEGER, op, NIL, l, intTemp(ti), intConst(ctx, 0));
 }
 
 /*
@@ -178,13 +211,13 @@ void genIf (unsigned ti, unsigned op) {
 */
 
 /* Generates a scalar declaration. */
-void genScalarDec (unsigned tt, const char *identifier) {
-    fprintf(irfp, "%s %s;\n", getCType(tt), identifier);
+void genScalarDec (CompileContext *ctx, unsigned tt, const char *identifier) {
+    fprintf(ctx->ir.fp, "%s %s;\n", (tt == TT_INTEGER ? "int" : "double"), identifier);
 }
 
 /* Generates a vector decalaration. */
-void genVectorDec (unsigned tt, unsigned n, const char *identifier) {
-    fprintf(irfp, "%s %s[%d];\n", getCType(tt), identifier, n);
+void genVectorDec (CompileContext *ctx, unsigned tt, unsigned n, const char *identifier) {
+    fprintf(ctx->ir.fp, "%s %s[%d];\n", (tt == TT_INTEGER ? "int" : "double"), identifier, n);
 }
 
 /*
@@ -194,13 +227,19 @@ void genVectorDec (unsigned tt, unsigned n, const char *identifier) {
 */
 
 /* Generates the main program header and opening brace */
-void genMainHeader () {
-    fprintf(irfp, "int main () {\n");
+void genMainHeader (CompileContext *ctx) {
+    fprintf(ctx->ir.fp, "int main () {\n");
 }
 
 /* Generates the return statement and closing brace for main */
-void genMainEnd () {
-    fprintf(irfp, "return 0;\n}\n");
+void genMainEnd (CompileContext *ctx) {
+    fprintf(ctx->ir.fp, "return 0;\n}\n");
+}
+
+/* Optimizes the code generated since the last flush, and writes it out as C. */
+void flushCode (CompileContext *ctx) {
+    IN_PHASE(ctx, PHASE_OPTIMIZE, optimizeCode(ctx));
+    emitCode(ctx);
 }
 
 /*
@@ -209,48 +248,158 @@ void genMainEnd () {
 ***************************************************************************
 */
 
-/* Generates a statement to scan in values. */
-void genReadLn (dataListType dataList) {
-    fprintf(irfp, "scanf(\"");
+/* Generates a statement to scan in values into the variables of argument list
+ * `args`. The arguments are evaluated as any expression first. */
+void genReadLn (CompileContext *ctx, unsigned args) {
+    const AstNode *arg;
+    unsigned count = 0;
 
-    // Generate format string.
-    for (int i = 0; i < dataList.length; i++) {
-        dataType *dt = dataList.list[i];
-        fprintf(irfp, "%s", (dt->tt == TT_INTEGER) ? "%d" : "%f");
+    for (unsigned n = args; n != AST_NONE; n = AST_NODE(ctx, n)->next) {
+        genExpression(ctx, n);
     }
-    fprintf(irfp, "\",");
-
-    // Generate argument list.
-    for (int i = 0; i < dataList.length; i++) {
-       dataType *dt = dataList.list[i];
-       fprintf(irfp, "&%s", identifierAtIndex(dt->id));
-       if (i < dataList.length - 1) {
-           fprintf(irfp, ",");
-       } 
+    for (unsigned n = args; n != AST_NONE; n = arg->next, count++) {
+        arg = AST_NODE(ctx, n);
+        addInstr(ctx, IR_PARAM, arg->tt, UNDEFINED, NIL, NIL, varValue(arg->tt, arg->a), noValue());
     }
+    addInstr(ctx, IR_READ, UNDEFINED, UNDEFINED, NIL, count, noValue(), noValue());
+}
 
-    fprintf(irfp, ");\n");
+/* Generates a statement to print the values of argument list `args`. Arguments
+ * are evaluated first, then printed from their T-Labels. */
+void genWriteLn (CompileContext *ctx, unsigned args) {
+    const AstNode *arg;
+    unsigned count = 0, *tn;
+
+    for (unsigned n = args; n != AST_NONE; n = AST_NODE(ctx, n)->next) {
+        count++;
+    }
+    if ((tn = malloc(count * sizeof(unsigned))) == NULL) {
+        fprintf(stderr, "Error: genWriteLn: Couldn't allocate argument list!\n");
+        exit(EXIT_FAILURE);
+    }
+    count = 0;
+    for (unsigned n = args; n != AST_NONE; n = AST_NODE(ctx, n)->next) {
+        tn[count++] = genExpression(ctx, n);
+    }
+    count = 0;
+    for (unsigned n = args; n != AST_NONE; n = arg->next, count++) {
+        arg = AST_NODE(ctx, n);
+        addInstr(ctx, IR_PARAM, arg->tt, UNDEFINED, NIL, NIL, tempValue(arg->tt, tn[count]), noValue());
+    }
+    addInstr(ctx, IR_WRITE, UNDEFINED, UNDEFINED, NIL, count, noValue(), noValue());
+    free(tn);
 }
 
-/* Generates a statement to print values. */
-void genWriteLn (dataListType dataList) {
-    fprintf(irfp, "printf(\"");
+/*
+***************************************************************************
+*                    Syntax-Tree Generation Routines
+***************************************************************************
+*/
+
+/* Generates a guard: a jump to L-Label `l` if the expression at node `n` is
+ * false. Comparisons are tested with their own operator, on the difference of
+ * their operands. It is taken in real arithmetic if either operand is real, so
+ * that its sign is exact. */
+static void genGuard (CompileContext *ctx, unsigned n, unsigned l) {
+    const AstNode *guard = AST_NODE(ctx, n);
+    unsigned ttx, tty, tx, ty;
+
+    if (guard->kind != AST_COMPARE) {
+        genIf(ctx, genExpression(ctx, n), UNDEFINED, l);
+        return;
+    }
+    ttx = AST_NODE(ctx, guard->a)->tt;
+    tty = AST_NODE(ctx, guard->b)->tt;
+    tx = genExpression(ctx, guard->a);
+    ty = genExpression(ctx, guard->b);
+    genIf(ctx, genBoolOp(ctx, (ttx == TT_REAL || tty == TT_REAL) ? TT_REAL : TT_INTEGER, ttx, tx, tty, ty), guard->op, l);
+}
 
-    // Generate format string.
-    for (int i = 0; i < dataList.length; i++) {
-        dataType *dt = dataList.list[i];
-        fprintf(irfp, "%s ", (dt->tt == TT_INTEGER) ? "%d" : "%f");
+/* Generates the statement at node `n` of the syntax tree (see ast.h). */
+void genStatement (CompileContext *ctx, unsigned n) {
+    const AstNode *node = AST_NODE(ctx, n), *var;
+    unsigned l, ti;
+
+    switch (node->kind) {
+        case AST_ASSIGN:
+            var = AST_NODE(ctx, node->a);
+            if (var->kind == AST_INDEX) {
+                ti = genExpression(ctx, var->b);
+                genVectorAssignment(ctx, AST_NODE(ctx, node->b)->tt, var->a, ti, var->c, genExpression(ctx, node->b));
+            } else {
+                genScalarAssignment(ctx, AST_NODE(ctx, node->b)->tt, var->a, genExpression(ctx, node->b));
+            }
+            return;
+
+        // Conditional: Reserve else and end labels.
+        case AST_IF:
+            l = getLbl(ctx);
+            reserveLbl(ctx, 2);
+            genGuard(ctx, node->a, l);
+            genStatement(ctx, node->b);
+            genGoto(ctx, l + 1);
+            genLblAt(ctx, l);
+            genStatement(ctx, node->c);
+            genLblAt(ctx, l + 1);
+            return;
+
+        // Loop: Reserve guard and exit labels.
+        case AST_WHILE:
+            l = getLbl(ctx);
+            reserveLbl(ctx, 2);
+            genLblAt(ctx, l);
+            genGuard(ctx, node->a, l + 1);
+            genStatement(ctx, node->b);
+            genGoto(ctx, l);
+            genLblAt(ctx, l + 1);
+            return;
+
+        case AST_BLOCK:
+            for (unsigned s = node->a; s != AST_NONE; s = AST_NODE(ctx, s)->next) {
+                genStatement(ctx, s);
+            }
+            return;
+
+        // Calls are unavailable, and reported by the parser.
+        case AST_CALL:
+            return;
+
+        case AST_READLN:
+            genReadLn(ctx, node->a);
+            return;
+
+        case AST_WRITELN:
+            genWriteLn(ctx, node->a);
+            return;
     }
-    fprintf(irfp, "\\n\",");
-
-    // Generate argument list.
-    for (int i = 0; i < dataList.length; i++) {
-       dataType *dt = dataList.list[i];
-       fprintf(irfp, "%s", identifierAtIndex(dt->id));
-       if (i < dataList.length - 1) {
-           fprintf(irfp, ",");
-       } 
+    fprintf(stderr, "Error: genStatement: Unknown node kind %u!\n", node->kind);
+    exit(EXIT_FAILURE);
+}
+
+/* Generates the declarations of declaration list `decls`. */
+void genDeclarations (CompileContext *ctx, unsigned decls) {
+    const AstNode *dec;
+
+    for (unsigned n = decls; n != AST_NONE; n = dec->next) {
+        dec = AST_NODE(ctx, n);
+        if (dec->kind == AST_VECTOR) {
+            genVectorDec(ctx, dec->tt, dec->b, identifierAtIndex(ctx, dec->a));
+        } else {
+            genScalarDec(ctx, dec->tt, identifierAtIndex(ctx, dec->a));
+        }
     }
+}
+
+/* Generates the main program of the program at node `n`: its declarations,
+ * then the body of main. Routines are not generated. */
+void genProgram (CompileContext *ctx, unsigned n) {
+    const AstNode *program = AST_NODE(ctx, n);
 
-    fprintf(irfp, ");\n");
-}
\ No newline at end of file
+    genDeclarations(ctx, program->a);
+    genMainHeader(ctx);
+    for (unsigned s = program->c; s != AST_NONE; s = AST_NODE(ctx, s)->next) {
+        genStatement(ctx, s);
+    }
+    flushCode(ctx);
+    genMainEnd(ctx);
+}
@@ -4,6 +4,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "mpio.h"
+#include "ir.h"
+#include "mptypes.h"
+#include "strtab.h"
 #include "mpascal.tab.h"
 
 /*
@@ -15,13 +18,12 @@
 */
 
 /*
-***************************************************************************
-*                   Symbolic Constants & Global Variables
-***************************************************************************
-*/
-
-/* The writable file pointer */
-extern FILE *irfp;
+ * The generator builds the code of the main program as three-address code
+ * (see ir.h), walking the syntax tree. The code is written out as C, after
+ * optimization, by flushCode: Once for the whole program, or once per
+ * statement in incremental mode (see ast.h). Declarations and the main
+ * header are written out directly.
+ */
 
 /*
 ***************************************************************************
@@ -29,23 +31,25 @@ extern FILE *irfp;
 ***************************************************************************
 */
 
-/* Generates a T-Label for given constant. Returns T-Label num */
-unsigned genConst (unsigned tt, double n);
+/* Generates a T-Label for the constant at value-index `vi`. Returns T-Label num */
+unsigned genConst (CompileContext *ctx, unsigned vi);
 
 /* Generates a T-Label for given identifier. Returns T-Label num */
-unsigned genId (unsigned tt, const char *identifier);
+unsigned genId (CompileContext *ctx, unsigned tt, unsigned id);
 
 /* Generates a T-Label for an T-indexed vector. Returns T-Label num. */
-unsigned genVecIdx (unsigned tt, const char *identifier, unsigned ti, unsigned vb);
+unsigned genVecIdx (CompileContext *ctx, unsigned tt, unsigned id, unsigned ti, unsigned vb);
 
 /* Generates a T-Label for a unary operation (-|+) ti. Returns T-Label num. */
-unsigned genUnaryOp (unsigned tt, unsigned operator, unsigned ti);
+unsigned genUnaryOp (CompileContext *ctx, unsigned tt, unsigned operator, unsigned ti);
 
-/* Generates a T-Label for arithmetic operation. (tx op ty). Returns T-Label num. */
-unsigned genArithOp (unsigned tt, unsigned operator, unsigned tx, unsigned ty);
+/* Generates a T-Label for arithmetic operation. (tx op ty). Returns T-Label num.
+ * The operands are of token-types `ttx` and `tty`. */
+unsigned genArithOp (CompileContext *ctx, unsigned tt, unsigned operator, unsigned ttx, unsigned tx, unsigned tty, unsigned ty);
 
-/* Generates a T-Label for a boolean operation (tx - ty). Returns T-Label num. */
-unsigned genBoolOp (unsigned tx, unsigned ty);
+/* Generates a T-Label for a boolean operation (tx - ty). Returns T-Label num.
+ * The operands are of token-types `ttx` and `tty`. */
+unsigned genBoolOp (CompileContext *ctx, unsigned tt, unsigned ttx, unsigned tx, unsigned tty, unsigned ty);
 
 /*
 ***************************************************************************
@@ -53,11 +57,11 @@ unsigned genBoolOp (unsigned tx, unsigned ty);
 ***************************************************************************
 */
 
-/* Generates a T-Label for a scalar assignment. */
-void genScalarAssignment (const char *identifier, unsigned ti);
+/* Generates a scalar assignment of T-Label ti, of token-type tt. */
+void genScalarAssignment (CompileContext *ctx, unsigned tt, unsigned id, unsigned ti);
 
-/* Generates a T-Label for a vector-index assignment. */
-void genVectorAssignment (const char *identifier, unsigned ti, unsigned vb, unsigned te);
+/* Generates a vector-index assignment of T-Label te, of token-type tt. */
+void genVectorAssignment (CompileContext *ctx, unsigned tt, unsigned id, unsigned ti, unsigned vb, unsigned te);
 
 /*
 ***************************************************************************
@@ -65,23 +69,30 @@ void genVectorAssignment (const char *identifier, unsigned ti, unsigned vb, unsi
 ***************************************************************************
 */
 
+/* Resets the T-Label and L-Label counters for a new compilation. */
+void resetLabels (CompileContext *ctx);
+
 /* Returns the current label */
-unsigned getLbl();
+unsigned getLbl (CompileContext *ctx);
+
+/* Returns the current T-Label */
+unsigned getTmp (CompileContext *ctx);
 
 /* Generates a L-Label. Returns L-Label num. */
-unsigned genLbl();
+unsigned genLbl (CompileContext *ctx);
 
 /* Generates a L-Label at given number. Returns L-Label num. */
-unsigned genLblAt (unsigned l);
+unsigned genLblAt (CompileContext *ctx, unsigned l);
 
 /* Reserves the next n L-Labels. */
-void reserveLbl (unsigned n);
+void reserveLbl (CompileContext *ctx, unsigned n);
 
 /* Generates a GOTO statement with destination L-Label */
-void genGoto (unsigned l);
+void genGoto (CompileContext *ctx, unsigned l);
 
-/* Generates a conditional statement (inverts op). Does not print newline. */
-void genIf (unsigned ti, unsigned op);
+/* Generates a conditional jump to L-Label l, taken if the guard ti is false
+ * (inverts op). Guards without a comparison operator are treated as (ti <> 0). */
+void genIf (CompileContext *ctx, unsigned ti, unsigned op, unsigned l);
 
 /*
 ***************************************************************************
@@ -90,10 +101,10 @@ void genIf (unsigned ti, unsigned op);
 */
 
 /* Generates a scalar declaration. */
-void genScalarDec (unsigned tt, const char *identifier);
+void genScalarDec (CompileContext *ctx, unsigned tt, const char *identifier);
 
 /* Generates a vector decalaration. */
-void genVectorDec (unsigned tt, unsigned n, const char *identifier);
+void genVectorDec (CompileContext *ctx, unsigned tt, unsigned n, const char *identifier);
 
 /*
 ***************************************************************************
@@ -102,10 +113,13 @@ void genVectorDec (unsigned tt, unsigned n, const char *identifier);
 */
 
 /* Generates the main program header and opening brace */
-void genMainHeader ();
+void genMainHeader (CompileContext *ctx);
 
 /* Generates the return statement and closing brace for main */
-void genMainEnd ();
+void genMainEnd (CompileContext *ctx);
+
+/* Optimizes the code generated since the last flush, and writes it out as C. */
+void flushCode (CompileContext *ctx);
 
 /*
 ***************************************************************************
@@ -113,11 +127,26 @@ void genMainEnd ();
 ***************************************************************************
 */
 
-/* Generates a statement to scan in values. */
-void genReadLn (dataListType dataList);
+/* Generates a statement to scan in values into the variables of argument list `args`. */
+void genReadLn (CompileContext *ctx, unsigned args);
+
+/* Generates a statement to print the values of argument list `args`. */
+void genWriteLn (CompileContext *ctx, unsigned args);
+
+/*
+***************************************************************************
+*                   Syntax-Tree Generation Prototypes
+***************************************************************************
+*/
+
+/* Generates the statement at node `n` of the syntax tree (see ast.h). */
+void genStatement (CompileContext *ctx, unsigned n);
 
-/* Generates a statement to print values. */
-void genWriteLn (dataListType dataList);
+/* Generates the declarations of declaration list `decls`. */
+void genDeclarations (CompileContext *ctx, unsigned decls);
 
+/* Generates the main program of the program at node `n`: its declarations,
+ * then the body of main. Routines are not generated. */
+void genProgram (CompileContext *ctx, unsigned n);
 
 #endif
\ No newline at end of file
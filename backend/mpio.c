@@ -1,4 +1,8 @@
-#include "mpio.h"
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "context.h"
 
 /*
 ***************************************************************************
@@ -11,32 +15,155 @@
 
 /*
 ***************************************************************************
-*                           Internal Routines
+*                           Routine Prototypes
 ***************************************************************************
 */
 
+/* Opens an in-memory buffer for IR generation, closing any previous one.
+ * Returns nonzero on error. Code is buffered so that nothing is written if 
+ * compilation fails. 
+*/
+int openIRBuffer (CompileContext *ctx) {
+    IRBuffer *ir = &ctx->ir;
+    if (ir->fp != NULL) {
+        closeIRBuffer(ctx);
+    }
+    if ((ir->fp = open_memstream(&ir->buffer, &ir->size)) == NULL) {
+        return 1;
+    }
+    fprintf(ir->fp, MPIR_FILE_HEADER);
+    return 0;
+}
 
-
-/*
-***************************************************************************
-*                           Routine Prototypes
-***************************************************************************
+/* Opens file descriptor `fd` for IR generation in place of the buffer, closing
+ * any previous one. Code is written as it is flushed. Returns nonzero on error.
+ * The stream writes to a duplicate of `fd`, so closing it leaves `fd` open.
 */
+int openIRStream (CompileContext *ctx, int fd) {
+    IRBuffer *ir = &ctx->ir;
+    int dupfd;
 
-/* Opens and formats a file for IR generation. Returns nonzero on error. */
-int openIRFile (const char *filename) {
-    if (filename == NULL || (irfp = fopen(filename, "w")) == NULL) {
+    if (ir->fp != NULL) {
+        closeIRBuffer(ctx);
+    }
+    if ((dupfd = dup(fd)) < 0) {
+        return 1;
+    }
+    if ((ir->fp = fdopen(dupfd, "w")) == NULL) {
+        close(dupfd);
         return 1;
     }
-    fprintf(irfp, MPIR_FILE_HEADER);
+    ir->stream = 1;
+    fprintf(ir->fp, MPIR_FILE_HEADER);
     return 0;
 }
 
-/* Closes any open writable file. */
-void closeIRFile (void) {
-    if (irfp != NULL) {
-        fclose(irfp);
+/* Writes out all code generated so far, if generating to a stream. Returns
+ * nonzero on error. */
+int flushIRStream (CompileContext *ctx) {
+    IRBuffer *ir = &ctx->ir;
+    if (ir->fp == NULL || !ir->stream) {
+        return 0;
+    }
+    return (fflush(ir->fp) != 0);
+}
+
+/* Returns the IR buffer and stores its length in `size`. NULL on error, or
+ * if generating to a stream. */
+const char *getIRBuffer (CompileContext *ctx, size_t *size) {
+    IRBuffer *ir = &ctx->ir;
+    if (ir->fp == NULL || ir->stream || fflush(ir->fp) != 0) {
+        return NULL;
+    }
+    *size = ir->size;
+    return ir->buffer;
+}
+
+/* Closes the IR buffer and returns it, NUL-terminated, storing its length in
+ * `size`. The caller takes ownership of the buffer. NULL on error, or if
+ * generating to a stream. */
+char *releaseIRBuffer (CompileContext *ctx, size_t *size) {
+    IRBuffer *ir = &ctx->ir;
+    char *buffer;
+    int err;
+
+    if (ir->fp == NULL || ir->stream) {
+        return NULL;
+    }
+    err = fclose(ir->fp);
+    buffer = ir->buffer;
+    *size = ir->size;
+    *ir = (IRBuffer){.fp = NULL, .buffer = NULL, .size = 0, .stream = 0};
+    if (err) {
+        free(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+/* Writes the IR buffer to the given file. Returns nonzero on error. */
+int writeIRFile (CompileContext *ctx, const char *filename) {
+    const char *buffer;
+    size_t size;
+    FILE *fp;
+    int err;
+
+    if ((buffer = getIRBuffer(ctx, &size)) == NULL) {
+        return 1;
+    }
+    if (filename == NULL || (fp = fopen(filename, "w")) == NULL) {
+        return 1;
+    }
+    err = (fwrite(buffer, 1, size, fp) != size);
+    return (fclose(fp) != 0 || err);
+}
+
+/* Writes the IR buffer to the standard input of shell command `command`.
+ * Returns nonzero on error or if the command fails. A command exiting before
+ * it read everything fails the write (EPIPE) rather than raising SIGPIPE. */
+int pipeIRBuffer (CompileContext *ctx, const char *command) {
+    const struct timespec now = {.tv_sec = 0, .tv_nsec = 0};
+    sigset_t pipeSet, oldSet, pending;
+    const char *buffer;
+    size_t size;
+    FILE *pp;
+    int err, raised;
+
+    if ((buffer = getIRBuffer(ctx, &size)) == NULL) {
+        return 1;
+    }
+
+    // Block SIGPIPE in this thread only, as other threads may be compiling.
+    sigemptyset(&pipeSet);
+    sigaddset(&pipeSet, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+    sigpending(&pending);
+    raised = sigismember(&pending, SIGPIPE);
+    if ((pp = popen(command, "w")) == NULL) {
+        err = 1;
+    } else {
+        err = (fwrite(buffer, 1, size, pp) != size);
+        err |= (pclose(pp) != 0);
+    }
+
+    // Discard a SIGPIPE raised by the writes above, then restore the mask.
+    if (!raised) {
+        while (sigtimedwait(&pipeSet, NULL, &now) == SIGPIPE) {
+            continue;
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &oldSet, NULL);
+    return err;
+}
+
+/* Closes and frees the IR buffer or stream, if open. The file descriptor of
+ * a stream is left open. */
+void closeIRBuffer (CompileContext *ctx) {
+    IRBuffer *ir = &ctx->ir;
+    if (ir->fp == NULL) {
         return;
     }
-    fprintf(stderr, "Warning: closeWritableIRFile: Already closed!\n");
-}
\ No newline at end of file
+    fclose(ir->fp);
+    free(ir->buffer);
+    *ir = (IRBuffer){.fp = NULL, .buffer = NULL, .size = 0, .stream = 0};
+}
@@ -21,8 +21,24 @@
 // Default filename for generated intermediate-representation C file.
 #define MPIR_DEFAULT_FILENAME   "mpp.c"
 
-/* The writable file pointer */
-FILE *irfp;
+/*
+***************************************************************************
+*                            Type Definitions
+***************************************************************************
+*/
+
+/* The IR output of a compilation: Either an in-memory buffer, or a stream to
+ * a file descriptor. The buffer and its size are only valid after flushing
+ * `fp`, and are NULL and zero for a stream. */
+typedef struct {
+    FILE *fp;                   // Writable file pointer (NULL if closed).
+    char *buffer;               // Generated code.
+    size_t size;                // Bytes of generated code.
+    int stream;                 // Nonzero if `fp` writes to a file descriptor.
+} IRBuffer;
+
+/* The context of a compilation (see context.h) */
+typedef struct compileContext CompileContext;
 
 /*
 ***************************************************************************
@@ -30,10 +46,37 @@ FILE *irfp;
 ***************************************************************************
 */
 
-/* Opens and formats a file for IR generation. Returns nonzero on error. */
-int openIRFile (const char *filename);
+/* Opens an in-memory buffer for IR generation, closing any previous one.
+ * Returns nonzero on error. */
+int openIRBuffer (CompileContext *ctx);
+
+/* Opens file descriptor `fd` for IR generation in place of the buffer, closing
+ * any previous one. Code is written as it is flushed. Returns nonzero on error. */
+int openIRStream (CompileContext *ctx, int fd);
+
+/* Writes out all code generated so far, if generating to a stream. Returns
+ * nonzero on error. */
+int flushIRStream (CompileContext *ctx);
+
+/* Returns the IR buffer and stores its length in `size`. NULL on error, or
+ * if generating to a stream. */
+const char *getIRBuffer (CompileContext *ctx, size_t *size);
+
+/* Closes the IR buffer and returns it, NUL-terminated, storing its length in
+ * `size`. The caller takes ownership of the buffer. NULL on error, or if
+ * generating to a stream. */
+char *releaseIRBuffer (CompileContext *ctx, size_t *size);
+
+/* Writes the IR buffer to the given file. Returns nonzero on error. */
+int writeIRFile (CompileContext *ctx, const char *filename);
+
+/* Writes the IR buffer to the standard input of shell command `command`.
+ * Returns nonzero on error or if the command fails. A command exiting before
+ * it read everything fails the write (EPIPE) rather than raising SIGPIPE. */
+int pipeIRBuffer (CompileContext *ctx, const char *command);
 
-/* Closes any open writable file. */
-void closeIRFile (void);
+/* Closes and frees the IR buffer or stream, if open. The file descriptor of
+ * a stream is left open. */
+void closeIRBuffer (CompileContext *ctx);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,1140 @@
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include "context.h"
+#include "passes.h"
+#include "semantics.h"
+
+/*
+***************************************************************************
+*                     Internal Type Definitions
+***************************************************************************
+*/
+
+/* Live range of a T-Label, over doubled instruction positions: Instruction i
+ * reads its operands at 2i, and assigns its T-Label at 2i + 1. */
+typedef struct {
+    unsigned lo, hi;        // First and last position the T-Label is live at (lo is NIL if never).
+    unsigned home;          // Block assigning the T-Label (NIL until found).
+    unsigned tt;            // Token-type of the T-Label.
+    unsigned slot;          // Pooled T-Label.
+    unsigned uses;          // Uses outside the home block: 1 + first in the use list, or 0.
+    unsigned starting;      // 1 + next T-Label whose range starts at `lo`, or 0.
+    unsigned ending;        // 1 + next T-Label whose range ends at `hi`, or 0.
+} Range;
+
+/* An expression available to common subexpression elimination: The operation
+ * of an instruction, the T-Label holding its value, and the state of memory it
+ * was computed in. */
+typedef struct {
+    const IRInstr *in;      // Instruction computing the expression.
+    unsigned epoch;         // Memory epoch it was computed in.
+    unsigned versions[2];   // Versions of its variable operands or vector, if any.
+    unsigned next;          // 1 + next expression of its hash bucket, or 0.
+} Expression;
+
+/* Scoped table of available expressions, along a path of the dominator tree.
+ * Expressions, and changes to variable versions, are undone in reverse order
+ * when leaving a block. */
+typedef struct {
+    Expression *exprs;      // Available expressions, innermost last.
+    unsigned count;
+    unsigned *buckets;      // Hash buckets: 1 + last expression of each, or 0.
+    unsigned mask;          // Buckets less one (a power of two).
+    unsigned *versions;     // Current version of each variable, by identifier-index.
+    unsigned *undo;         // Pairs (identifier-index, previous version).
+    unsigned undone;        // Pairs in `undo`.
+    unsigned epoch;         // Current memory epoch.
+    unsigned clock;         // Last version or epoch handed out.
+} ValueTable;
+
+/* A natural loop: A header, and the blocks which reach a jump back to it
+ * without passing through it. */
+typedef struct {
+    unsigned header;        // Header block, dominating the loop.
+    unsigned first, count;  // Blocks of the loop: `count` from `first` in the member list.
+    unsigned hoisted;       // 1 + first instruction hoisted into its preheader, or 0.
+    unsigned last;          // 1 + last instruction hoisted, or 0.
+} Loop;
+
+/*
+***************************************************************************
+*                           Internal Routines
+***************************************************************************
+*/
+
+/* Returns a zeroed array of `n` unsigned counters. */
+static unsigned *newCounters (unsigned n) {
+    unsigned *counters = calloc(n + 1, sizeof(unsigned));
+    if (counters == NULL) {
+        fprintf(stderr, "Error: passes: Couldn't allocate counters!\n");
+        exit(EXIT_FAILURE);
+    }
+    return counters;
+}
+
+/* Returns nonzero if block `b` holds nothing but labels and removed instructions. */
+static int isEmptyBlock (CompileContext *ctx, unsigned b) {
+    const IRBlock *block = IR_BLOCK(ctx, b);
+    for (unsigned i = block->first; i < block->last; i++) {
+        if (IR_INSTR(ctx, i)->kind != IR_LABEL && IR_INSTR(ctx, i)->kind != IR_NOP) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Returns the last instruction of block `b`, skipping removed ones. NULL if none. */
+static IRInstr *lastInstr (CompileContext *ctx, unsigned b) {
+    const IRBlock *block = IR_BLOCK(ctx, b);
+    for (unsigned i = block->last; i > block->first; i--) {
+        if (IR_INSTR(ctx, i - 1)->kind != IR_NOP) {
+            return IR_INSTR(ctx, i - 1);
+        }
+    }
+    return NULL;
+}
+
+/* Returns the block where control ends up when entering block `b`: Empty
+ * blocks are passed through, as are blocks holding only a goto. */
+static unsigned jumpDestination (CompileContext *ctx, unsigned b) {
+    IRInstr *in;
+
+    // Bounded by the number of blocks, in case of an empty infinite loop.
+    for (unsigned n = 0; n < ctx->code.blockCount; n++) {
+        if (isEmptyBlock(ctx, b) && b + 1 < ctx->code.blockCount) {
+            b = b + 1;
+        } else if ((in = lastInstr(ctx, b)) != NULL && in->kind == IR_GOTO && in == IR_INSTR(ctx, IR_BLOCK(ctx, b)->first + 1)
+                   && IR_INSTR(ctx, IR_BLOCK(ctx, b)->first)->kind == IR_LABEL) {
+            b = blockOfLabel(ctx, in->x);
+        } else {
+            break;
+        }
+    }
+    return b;
+}
+
+/* Widens range `r` to cover position `p`. */
+static void widen (Range *r, unsigned p) {
+    r->lo = (p < r->lo ? p : r->lo);
+    r->hi = (p > r->hi ? p : r->hi);
+}
+
+/* Returns the index of the instruction reading the operands of instruction
+ * `i`: IR_PARAMs are read by the IR_READ or IR_WRITE after them. */
+static unsigned readerOf (CompileContext *ctx, unsigned i) {
+    while (IR_INSTR(ctx, i)->kind == IR_PARAM || IR_INSTR(ctx, i)->kind == IR_NOP) {
+        i++;
+    }
+    return i;
+}
+
+/* Returns the instruction before instruction `i` in its block, skipping
+ * removed ones. NULL if none. */
+static IRInstr *previousInstr (CompileContext *ctx, unsigned b, unsigned i) {
+    while (i > IR_BLOCK(ctx, b)->first) {
+        if (IR_INSTR(ctx, --i)->kind != IR_NOP) {
+            return IR_INSTR(ctx, i);
+        }
+    }
+    return NULL;
+}
+
+/* Returns the constant at value-index `vi` converted to token-type `tt`, as C
+ * converts it: Reals become integers by truncation. Returns NIL if there is no
+ * constant, if it isn't finite, or if it doesn't fit an int. */
+static unsigned convertConstant (CompileContext *ctx, unsigned tt, unsigned vi) {
+    long long *i;
+    double r;
+
+    if (vi == NIL || !numberAtIndex(ctx, vi, &r) || !isfinite(r)) {
+        return NIL;
+    }
+    if (tt == TT_REAL) {
+        return (integerAtIndex(ctx, vi) != NULL ? installReal(ctx, r) : vi);
+    }
+    if ((i = integerAtIndex(ctx, vi)) != NULL) {
+        return (*i >= INT_MIN && *i <= INT_MAX ? vi : NIL);
+    }
+    return (r > INT_MIN - 1.0 && r < INT_MAX + 1.0 ? installInteger(ctx, (long long)r) : NIL);
+}
+
+/* Folds instruction `in` if its operands are constants, with the semantics of
+ * the C it is emitted as: An operation becomes a copy of its result, and a
+ * branch becomes a goto or is removed. Division by zero is left to run, as
+ * are results which overflow an int or aren't finite. Returns nonzero if a
+ * branch was folded. */
+static int foldInstr (CompileContext *ctx, IRInstr *in) {
+    unsigned vi = NIL;
+    double divisor;
+
+    if (in->a.kind != VAL_CONST || (in->kind != IR_UNARY && in->b.kind != VAL_CONST)) {
+        return 0;
+    }
+    switch (in->kind) {
+        case IR_UNARY:
+            vi = applySign(ctx, in->op, initExprVarType(TC_SCALAR, in->a.tt, in->a.index)).vi;
+            break;
+        case IR_ARITH:
+            numberAtIndex(ctx, in->b.index, &divisor);
+            if ((in->op == MP_DIVOP || in->op == MP_MODOP) && divisor == 0.0) {
+                return 0;
+            }
+            if (in->op == MP_MODOP && (in->a.tt == TT_REAL || in->b.tt == TT_REAL)) {
+                return 0;
+            }
+            vi = foldOperation(ctx, in->op, in->a.index, in->b.index);
+            break;
+        case IR_BRANCH:
+            if ((vi = foldOperation(ctx, in->op, in->a.index, in->b.index)) == NIL) {
+                return 0;
+            }
+            in->kind = (*integerAtIndex(ctx, vi) != 0 ? IR_GOTO : IR_NOP);
+            return 1;
+        default:
+            return 0;
+    }
+    if ((vi = convertConstant(ctx, in->tt, vi)) != NIL) {
+        in->kind = IR_MOVE;
+        in->a = constValue(ctx, vi);
+        in->b = (IRValue){.kind = VAL_NONE, .tt = UNDEFINED, .index = 0};
+    }
+    return 0;
+}
+
+/* Returns nonzero if the operation of instruction `in` may be shared by
+ * common subexpression elimination. Copies are left to copy propagation. */
+static int isShareable (const IRInstr *in) {
+    return (in->kind == IR_UNARY || in->kind == IR_ARITH || in->kind == IR_LOAD);
+}
+
+/* Returns the identifier-indices read by instruction `in` in `ids`, or NIL:
+ * Its variable operands, or the vector it loads from and its index variable. */
+static void memoryOperands (const IRInstr *in, unsigned ids[2]) {
+    if (in->kind == IR_LOAD) {
+        ids[0] = in->x;
+        ids[1] = (in->a.kind == VAL_VAR ? in->a.index : NIL);
+        return;
+    }
+    ids[0] = (in->a.kind == VAL_VAR ? in->a.index : NIL);
+    ids[1] = (in->b.kind == VAL_VAR ? in->b.index : NIL);
+}
+
+/* Returns nonzero if operands `a` and `b` are the same. */
+static int sameValue (IRValue a, IRValue b) {
+    return (a.kind == b.kind && a.index == b.index && a.tt == b.tt);
+}
+
+/* Returns nonzero if instructions `x` and `y` compute the same operation on the
+ * same operands. Operands of + and * may be swapped. */
+static int sameOperation (const IRInstr *x, const IRInstr *y) {
+    if (x->kind != y->kind || x->op != y->op || x->tt != y->tt || x->x != y->x || x->disp != y->disp) {
+        return 0;
+    }
+    if (sameValue(x->a, y->a) && sameValue(x->b, y->b)) {
+        return 1;
+    }
+    return (x->kind == IR_ARITH && (x->op == MP_ADDOP || x->op == MP_MULOP)
+            && sameValue(x->a, y->b) && sameValue(x->b, y->a));
+}
+
+/* Returns the hash of the operation of instruction `in`, alike for swapped operands. */
+static unsigned hashOperation (const IRInstr *in) {
+    unsigned ha = in->a.kind * 31 + in->a.index * 2654435761u, hb = in->b.kind * 31 + in->b.index * 2654435761u;
+    return ((in->kind * 131 + in->op) * 31 + in->tt) * 2654435761u + (in->x + (unsigned)in->disp * 97u) * 40503u + (ha ^ hb) + ha * hb;
+}
+
+/* Returns the available expression computing the operation of instruction
+ * `in`, or NULL. Expressions reading variables or vectors are only available
+ * while those are unchanged, within the memory epoch they were computed in. */
+static const Expression *findExpression (ValueTable *table, const IRInstr *in) {
+    for (unsigned e = table->buckets[hashOperation(in) & table->mask]; e != 0; e = table->exprs[e - 1].next) {
+        const Expression *expr = &table->exprs[e - 1];
+        unsigned ids[2];
+        if (!sameOperation(expr->in, in)) {
+            continue;
+        }
+        memoryOperands(expr->in, ids);
+        if (ids[0] == NIL && ids[1] == NIL) {
+            return expr;
+        }
+        if (expr->epoch == table->epoch && (ids[0] == NIL || expr->versions[0] == table->versions[ids[0]])
+            && (ids[1] == NIL || expr->versions[1] == table->versions[ids[1]])) {
+            return expr;
+        }
+    }
+    return NULL;
+}
+
+/* Makes the operation of instruction `in` available, as its T-Label. */
+static void addExpression (ValueTable *table, const IRInstr *in) {
+    unsigned h = hashOperation(in) & table->mask, ids[2];
+    Expression *expr = &table->exprs[table->count];
+
+    memoryOperands(in, ids);
+    *expr = (Expression){.in = in, .epoch = table->epoch, .next = table->buckets[h]};
+    expr->versions[0] = (ids[0] == NIL ? 0 : table->versions[ids[0]]);
+    expr->versions[1] = (ids[1] == NIL ? 0 : table->versions[ids[1]]);
+    table->buckets[h] = ++table->count;
+}
+
+/* Gives variable or vector `id` a new version, so expressions reading it are
+ * no longer available. */
+static void writeVariable (ValueTable *table, unsigned id) {
+    table->undo[2 * table->undone] = id;
+    table->undo[2 * table->undone + 1] = table->versions[id];
+    table->undone++;
+    table->versions[id] = ++table->clock;
+}
+
+/* Returns nonzero if instruction `in` may fault when run where it wasn't
+ * before: Loads, and divisions by integers that may be 0 or -1. */
+static int mayTrap (CompileContext *ctx, const IRInstr *in) {
+    long long *divisor;
+
+    if (in->kind == IR_LOAD) {
+        return 1;
+    }
+    if (in->kind != IR_ARITH || (in->op != MP_DIVOP && in->op != MP_MODOP)) {
+        return 0;
+    }
+    if (in->op == MP_DIVOP && (in->a.tt == TT_REAL || in->b.tt == TT_REAL)) {
+        return 0;
+    }
+    return (in->b.kind != VAL_CONST || (divisor = integerAtIndex(ctx, in->b.index)) == NULL || *divisor == 0 || *divisor == -1);
+}
+
+/* Returns nonzero if instruction `in` computes an int the C may overflow, which
+ * is undefined where the program never computed it: Integer arithmetic, and
+ * differences of reals taken as integers. Constant operands are folded before. */
+static int mayOverflow (const IRInstr *in) {
+    return ((in->kind == IR_UNARY && in->op == MP_SUBOP) || in->kind == IR_ARITH) && in->tt == TT_INTEGER;
+}
+
+/* Orders loops by their number of blocks, so inner loops come first. */
+static int compareLoops (const void *x, const void *y) {
+    const Loop *a = x, *b = y;
+    return (a->count > b->count) - (a->count < b->count);
+}
+
+/* Finds the natural loops of the code, with their members. Dominators must
+ * be found. Returns the number of loops. The loops and members must be freed. */
+static unsigned findLoops (CompileContext *ctx, Loop **loops, unsigned **members) {
+    IRCode *code = &ctx->code;
+    unsigned n = code->blockCount, count = 0, used = 0, size = n, *mark = newCounters(n), *stack = newCounters(n), top;
+
+    *loops = malloc((n + 1) * sizeof(Loop));
+    *members = malloc((size + 1) * sizeof(unsigned));
+    if (*loops == NULL || *members == NULL) {
+        fprintf(stderr, "Error: findLoops: Couldn't allocate loops!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned h = 0; h < n; h++) {
+        const IRBlock *header = IR_BLOCK(ctx, h);
+        Loop *loop = &(*loops)[count];
+
+        // Walk back from each jump back to the header.
+        *loop = (Loop){.header = h, .first = used, .count = 0, .hoisted = 0, .last = 0};
+        top = 0;
+        for (unsigned k = 0; k < header->preds; k++) {
+            unsigned p = code->preds[header->pred + k];
+            if (dominates(ctx, h, p) && mark[p] != h + 1) {
+                mark[p] = h + 1;
+                stack[top++] = p;
+            }
+        }
+        if (top == 0) {
+            continue;
+        }
+        if (mark[h] != h + 1) {
+            mark[h] = h + 1;
+            stack[top++] = h;
+        }
+        while (top > 0) {
+            unsigned b = stack[--top];
+            if (used == size) {
+                size *= 2;
+                if ((*members = realloc(*members, (size + 1) * sizeof(unsigned))) == NULL) {
+                    fprintf(stderr, "Error: findLoops: Couldn't allocate loops!\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            (*members)[used++] = b;
+            loop->count++;
+            for (unsigned k = 0; b != h && k < IR_BLOCK(ctx, b)->preds; k++) {
+                unsigned p = code->preds[IR_BLOCK(ctx, b)->pred + k];
+                if (mark[p] != h + 1 && IR_BLOCK(ctx, p)->idom != NIL) {
+                    mark[p] = h + 1;
+                    stack[top++] = p;
+                }
+            }
+        }
+        count++;
+    }
+    free(mark);
+    free(stack);
+    return count;
+}
+
+/*
+***************************************************************************
+*                               Passes
+***************************************************************************
+*/
+
+/* Jumps: Retargets jumps to empty blocks and to gotos at their final
+ * destination. Then removes jumps to the next block, unreachable blocks and
+ * labels no jump refers to. Repeats until nothing changes. */
+static void simplifyJumps (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    unsigned labels, *refs, *stack, top, b, s;
+    unsigned char *reachable;
+    int changed;
+
+    do {
+        changed = 0;
+        labels = ctx->l - code->firstLbl;
+
+        // (1). Thread jumps, and remove those falling through anyway.
+        for (b = 0; b < code->blockCount; b++) {
+            IRInstr *in = lastInstr(ctx, b);
+            if (in == NULL || (in->kind != IR_GOTO && in->kind != IR_BRANCH)) {
+                continue;
+            }
+            s = jumpDestination(ctx, blockOfLabel(ctx, in->x));
+            if (IR_BLOCK(ctx, s)->label != NIL && IR_BLOCK(ctx, s)->label != in->x) {
+                in->x = IR_BLOCK(ctx, s)->label;
+                changed = 1;
+            }
+            if (b + 1 < code->blockCount && jumpDestination(ctx, b + 1) == s) {
+                in->kind = IR_NOP;
+                changed = 1;
+            }
+        }
+        buildBlocks(ctx);
+
+        // (2). Remove blocks not reachable from the first.
+        if (code->blockCount > 0) {
+            reachable = calloc(code->blockCount, 1);
+            stack = newCounters(code->blockCount);
+            if (reachable == NULL) {
+                fprintf(stderr, "Error: simplifyJumps: Couldn't allocate block marks!\n");
+                exit(EXIT_FAILURE);
+            }
+            reachable[0] = 1;
+            stack[0] = 0;
+            top = 1;
+            while (top > 0) {
+                b = stack[--top];
+                for (int k = 0; k < 2; k++) {
+                    if ((s = IR_BLOCK(ctx, b)->succ[k]) != NIL && !reachable[s]) {
+                        reachable[s] = 1;
+                        stack[top++] = s;
+                    }
+                }
+            }
+            for (b = 0; b < code->blockCount; b++) {
+                for (unsigned i = IR_BLOCK(ctx, b)->first; !reachable[b] && i < IR_BLOCK(ctx, b)->last; i++) {
+                    IR_INSTR(ctx, i)->kind = IR_NOP;
+                    changed = 1;
+                }
+            }
+            free(reachable);
+            free(stack);
+        }
+
+        // (3). Remove labels without jumps.
+        refs = newCounters(labels);
+        for (unsigned i = 0; i < code->count; i++) {
+            const IRInstr *in = IR_INSTR(ctx, i);
+            if (in->kind == IR_GOTO || in->kind == IR_BRANCH) {
+                refs[in->x - code->firstLbl]++;
+            }
+        }
+        for (unsigned i = 0; i < code->count; i++) {
+            IRInstr *in = IR_INSTR(ctx, i);
+            if (in->kind == IR_LABEL && refs[in->x - code->firstLbl] == 0) {
+                in->kind = IR_NOP;
+                changed = 1;
+            }
+        }
+        free(refs);
+        buildBlocks(ctx);
+    } while (changed);
+}
+
+/* Copies: Forwards the T-Labels, variables and constants copied into T-Labels
+ * to the uses of those T-Labels later in the same block, so that the copies
+ * die. A variable is forwarded until it is next assigned or read into.
+ * Instructions left with constant operands are folded (see foldInstr), and so
+ * become copies themselves: Constant expressions fold whole. */
+static void propagateCopies (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    int folded = 0;
+    unsigned temps = ctx->t - code->firstTmp, *owner = newCounters(temps), *version = newCounters(temps);
+    unsigned *writes = newCounters(ctx->strtab.sp);
+    IRValue *copies = malloc((temps + 1) * sizeof(IRValue));
+
+    if (copies == NULL) {
+        fprintf(stderr, "Error: propagateCopies: Couldn't allocate copies!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned b = 0; b < code->blockCount; b++) {
+        for (unsigned i = IR_BLOCK(ctx, b)->first; i < IR_BLOCK(ctx, b)->last; i++) {
+            IRInstr *in = IR_INSTR(ctx, i);
+            if (in->kind == IR_NOP) {
+                continue;
+            }
+
+            // Forward the copies still valid (owned by this block, and not overwritten).
+            IRValue *operands[2] = {&in->a, &in->b};
+            for (int k = 0; k < 2; k++) {
+                unsigned t = operands[k]->index - code->firstTmp;
+                if (operands[k]->kind == VAL_TEMP && owner[t] == b + 1
+                    && (copies[t].kind != VAL_VAR || version[t] == writes[copies[t].index])) {
+                    *operands[k] = copies[t];
+                }
+            }
+            folded |= foldInstr(ctx, in);
+
+            // Record new copies, and count assignments to variables.
+            if (in->kind == IR_MOVE) {
+                unsigned t = in->dst - code->firstTmp;
+                copies[t] = in->a;
+                owner[t] = b + 1;
+                version[t] = (in->a.kind == VAL_VAR ? writes[in->a.index] : 0);
+            } else if (in->kind == IR_STORE) {
+                writes[in->x]++;
+            } else if (in->kind == IR_READ) {
+                for (unsigned j = i, n = 0; n < in->x; ) {
+                    const IRInstr *arg = IR_INSTR(ctx, --j);
+                    if (arg->kind == IR_PARAM) {
+                        writes[arg->a.index]++;
+                        n++;
+                    }
+                }
+            }
+        }
+    }
+    free(owner);
+    free(version);
+    free(writes);
+    free(copies);
+    if (folded) {
+        buildBlocks(ctx);
+    }
+}
+
+/* Peephole: Fuses a subtraction tested against zero by the branch right after
+ * it, its only use, into a branch comparing the operands: (t = x - y; if
+ * (t < 0)) becomes (if (x < y)). Only where the subtraction is taken in the
+ * type of its operands, as a truncated difference may have another sign. */
+static void fuseCompares (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    unsigned temps = ctx->t - code->firstTmp, *uses = newCounters(temps);
+    IRInstr *def;
+    long long *zero;
+
+    for (unsigned i = 0; i < code->count; i++) {
+        const IRInstr *in = IR_INSTR(ctx, i);
+        if (in->kind == IR_NOP) {
+            continue;
+        }
+        if (in->a.kind == VAL_TEMP) {
+            uses[in->a.index - code->firstTmp]++;
+        }
+        if (in->b.kind == VAL_TEMP) {
+            uses[in->b.index - code->firstTmp]++;
+        }
+    }
+    for (unsigned b = 0; b < code->blockCount; b++) {
+        IRInstr *in = lastInstr(ctx, b);
+        if (in == NULL || in->kind != IR_BRANCH || in->a.kind != VAL_TEMP || in->b.kind != VAL_CONST
+            || (zero = integerAtIndex(ctx, in->b.index)) == NULL || *zero != 0 || uses[in->a.index - code->firstTmp] != 1) {
+            continue;
+        }
+        def = previousInstr(ctx, b, (unsigned)(in - code->instrs));
+        if (def == NULL || def->kind != IR_ARITH || def->op != MP_SUBOP || def->dst != in->a.index
+            || (def->tt != TT_REAL && (def->a.tt != TT_INTEGER || def->b.tt != TT_INTEGER))) {
+            continue;
+        }
+        in->a = def->a;
+        in->b = def->b;
+        def->kind = IR_NOP;
+    }
+    free(uses);
+}
+
+/* Indices: Folds the integer constant added to or subtracted from the index of
+ * a vector access into its displacement, so (t = i - 1; v[t]) becomes v[i - 1]
+ * and the lower bound of the vector is taken off by the addressing, with no
+ * instruction of its own. Folds chains of such offsets, within a block, while
+ * the variables they read are unchanged. The offsets left unused are removed
+ * as dead code. */
+static void foldIndices (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    unsigned temps = ctx->t - code->firstTmp, *def = newCounters(temps), *written = newCounters(ctx->strtab.sp);
+    long long *c, disp;
+
+    for (unsigned b = 0; b < code->blockCount; b++) {
+        for (unsigned i = IR_BLOCK(ctx, b)->first; i < IR_BLOCK(ctx, b)->last; i++) {
+            IRInstr *in = IR_INSTR(ctx, i);
+
+            // Record the T-Labels assigned in the block, and the last assignment to each variable.
+            if (isPure(in)) {
+                def[in->dst - code->firstTmp] = i + 1;
+            } else if (in->kind == IR_STORE) {
+                written[in->x] = i + 1;
+            } else if (in->kind == IR_READ) {
+                for (unsigned j = i, n = 0; n < in->x; ) {
+                    const IRInstr *arg = IR_INSTR(ctx, --j);
+                    if (arg->kind == IR_PARAM) {
+                        written[arg->a.index] = i + 1;
+                        n++;
+                    }
+                }
+            }
+            if (in->kind != IR_LOAD && in->kind != IR_STORE_INDEX) {
+                continue;
+            }
+
+            // Fold the offsets of the index, nearest first.
+            while (in->a.kind == VAL_TEMP) {
+                unsigned d = def[in->a.index - code->firstTmp];
+                const IRInstr *offset = (d > IR_BLOCK(ctx, b)->first ? IR_INSTR(ctx, d - 1) : NULL);
+                IRValue base;
+
+                if (offset == NULL || offset->kind != IR_ARITH || offset->tt != TT_INTEGER
+                    || (offset->op != MP_ADDOP && offset->op != MP_SUBOP)) {
+                    break;
+                }
+                if (offset->b.kind == VAL_CONST && (c = integerAtIndex(ctx, offset->b.index)) != NULL) {
+                    base = offset->a;
+                    disp = (offset->op == MP_ADDOP ? in->disp + *c : in->disp - *c);
+                } else if (offset->op == MP_ADDOP && offset->a.kind == VAL_CONST && (c = integerAtIndex(ctx, offset->a.index)) != NULL) {
+                    base = offset->b;
+                    disp = in->disp + *c;
+                } else {
+                    break;
+                }
+                if (base.tt != TT_INTEGER || base.kind == VAL_CONST || disp < -INT_MAX || disp > INT_MAX
+                    || (base.kind == VAL_VAR && written[base.index] >= d)) {
+                    break;
+                }
+                in->a = base;
+                in->disp = (int)disp;
+            }
+        }
+    }
+    free(def);
+    free(written);
+}
+
+/* CSE: Removes operations computed before, on every path to them. Walks the
+ * dominator tree, keeping the expressions computed in the dominators of each
+ * block available in it, where it reuses their T-Labels. Expressions on
+ * T-Labels and constants stay available throughout (T-Labels are assigned
+ * once). Those reading variables or vectors stay available until the variable
+ * or vector is assigned or read into, and only into blocks entered from their
+ * dominator alone: Other paths into a block may change memory. */
+static void eliminateCommonSubexpressions (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    unsigned temps = ctx->t - code->firstTmp, *replace, *child, *sibling, *stack, top = 0, *marks, buckets = 1;
+    ValueTable table = {.count = 0, .undone = 0, .epoch = 0, .clock = 0};
+
+    if (code->blockCount == 0) {
+        return;
+    }
+    replace = newCounters(temps);
+    child = newCounters(code->blockCount);
+    sibling = newCounters(code->blockCount);
+    stack = newCounters(2 * code->blockCount);
+    marks = newCounters(3 * code->blockCount);
+    while (buckets < 2 * code->count) {
+        buckets *= 2;
+    }
+    table.mask = buckets - 1;
+    table.buckets = newCounters(buckets);
+    table.versions = newCounters(ctx->strtab.sp);
+    table.undo = newCounters(2 * code->count);
+    if ((table.exprs = malloc((code->count + 1) * sizeof(Expression))) == NULL) {
+        fprintf(stderr, "Error: eliminateCommonSubexpressions: Couldn't allocate expressions!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // (1). Build the dominator tree: First child and next sibling of each block (1 + block, or 0).
+    findDominators(ctx);
+    for (unsigned b = code->blockCount; b-- > 1; ) {
+        unsigned d = IR_BLOCK(ctx, b)->idom;
+        if (d != NIL) {
+            sibling[b] = child[d];
+            child[d] = b + 1;
+        }
+    }
+
+    // (2). Walk it, entering each block (2b) and leaving it (2b + 1) once its children are done.
+    stack[top++] = 0;
+    while (top > 0) {
+        unsigned entry = stack[--top], b = entry / 2;
+        const IRBlock *block = IR_BLOCK(ctx, b);
+
+        if (entry % 2 == 1) {
+            while (table.count > marks[3 * b]) {
+                const Expression *expr = &table.exprs[--table.count];
+                table.buckets[hashOperation(expr->in) & table.mask] = expr->next;
+            }
+            while (table.undone > marks[3 * b + 1]) {
+                table.undone--;
+                table.versions[table.undo[2 * table.undone]] = table.undo[2 * table.undone + 1];
+            }
+            table.epoch = marks[3 * b + 2];
+            continue;
+        }
+        marks[3 * b] = table.count;
+        marks[3 * b + 1] = table.undone;
+        marks[3 * b + 2] = table.epoch;
+        if (block->preds > 1) {
+            table.epoch = ++table.clock;
+        }
+
+        for (unsigned i = block->first; i < block->last; i++) {
+            IRInstr *in = IR_INSTR(ctx, i);
+            const Expression *expr;
+            if (in->kind == IR_NOP) {
+                continue;
+            }
+            if (in->a.kind == VAL_TEMP && replace[in->a.index - code->firstTmp] != 0) {
+                in->a.index = replace[in->a.index - code->firstTmp] - 1;
+            }
+            if (in->b.kind == VAL_TEMP && replace[in->b.index - code->firstTmp] != 0) {
+                in->b.index = replace[in->b.index - code->firstTmp] - 1;
+            }
+            if (isShareable(in)) {
+                if ((expr = findExpression(&table, in)) != NULL) {
+                    replace[in->dst - code->firstTmp] = expr->in->dst + 1;
+                    in->kind = IR_NOP;
+                } else {
+                    addExpression(&table, in);
+                }
+            } else if (in->kind == IR_STORE || in->kind == IR_STORE_INDEX) {
+                writeVariable(&table, in->x);
+            } else if (in->kind == IR_READ) {
+                for (unsigned j = i, n = 0; n < in->x; ) {
+                    const IRInstr *arg = IR_INSTR(ctx, --j);
+                    if (arg->kind == IR_PARAM) {
+                        writeVariable(&table, arg->a.index);
+                        n++;
+                    }
+                }
+            }
+        }
+
+        stack[top++] = 2 * b + 1;
+        for (unsigned c = child[b]; c != 0; c = sibling[c - 1]) {
+            stack[top++] = 2 * (c - 1);
+        }
+    }
+    free(replace);
+    free(child);
+    free(sibling);
+    free(stack);
+    free(marks);
+    free(table.exprs);
+    free(table.buckets);
+    free(table.versions);
+    free(table.undo);
+}
+
+/* Hoists the invariants of every loop into its preheader, inner loops first.
+ * Each instruction moves at most once. Returns nonzero if any moved. */
+static int hoistInvariants (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    unsigned n = code->blockCount, temps = ctx->t - code->firstTmp, loopCount, *members, moved = 0, labels = 0, count;
+    unsigned *inLoop = newCounters(n), *always = newCounters(n), *written = newCounters(ctx->strtab.sp);
+    unsigned *defBlock = newCounters(temps), *invariant = newCounters(temps), *next = newCounters(code->count);
+    unsigned *hoisted = newCounters(code->count), *label = newCounters(n);
+    IRInstr *instrs;
+    Loop *loops;
+
+    findDominators(ctx);
+    loopCount = findLoops(ctx, &loops, &members);
+    qsort(loops, loopCount, sizeof(Loop), compareLoops);
+    for (unsigned b = 0; b < n; b++) {
+        for (unsigned i = IR_BLOCK(ctx, b)->first; i < IR_BLOCK(ctx, b)->last; i++) {
+            if (isPure(IR_INSTR(ctx, i))) {
+                defBlock[IR_INSTR(ctx, i)->dst - code->firstTmp] = b + 1;
+            }
+        }
+    }
+
+    for (unsigned l = 0; l < loopCount; l++) {
+        Loop *loop = &loops[l];
+        unsigned stamp = l + 1, h = loop->header;
+
+        // (1). Mark the loop, and what it assigns. Skip loops falling back into their header.
+        for (unsigned k = 0; k < loop->count; k++) {
+            inLoop[members[loop->first + k]] = stamp;
+        }
+        if (h > 0 && inLoop[h - 1] == stamp && IR_BLOCK(ctx, h - 1)->succ[0] == h) {
+            continue;
+        }
+        for (unsigned k = 0; k < loop->count; k++) {
+            const IRBlock *block = IR_BLOCK(ctx, members[loop->first + k]);
+            for (unsigned i = block->first; i < block->last; i++) {
+                const IRInstr *in = IR_INSTR(ctx, i);
+                if (in->kind == IR_STORE || in->kind == IR_STORE_INDEX) {
+                    written[in->x] = stamp;
+                } else if (in->kind == IR_READ) {
+                    for (unsigned j = i, m = 0; m < in->x; ) {
+                        const IRInstr *arg = IR_INSTR(ctx, --j);
+                        if (arg->kind == IR_PARAM) {
+                            written[arg->a.index] = stamp;
+                            m++;
+                        }
+                    }
+                }
+            }
+        }
+
+        // (2). Find the blocks run on every pass: Those dominating every exit.
+        for (unsigned k = 0; k < loop->count; k++) {
+            always[members[loop->first + k]] = stamp;
+        }
+        for (unsigned k = 0; k < loop->count; k++) {
+            unsigned e = members[loop->first + k];
+            const IRBlock *exit = IR_BLOCK(ctx, e);
+            if ((exit->succ[0] == NIL || inLoop[exit->succ[0]] == stamp) && (exit->succ[1] == NIL || inLoop[exit->succ[1]] == stamp)) {
+                continue;
+            }
+            for (unsigned j = 0; j < loop->count; j++) {
+                unsigned b = members[loop->first + j];
+                if (always[b] == stamp && !dominates(ctx, b, e)) {
+                    always[b] = 0;
+                }
+            }
+        }
+
+        // (3). Hoist the invariants, in order.
+        for (unsigned b = 0; b < n; b++) {
+            if (inLoop[b] != stamp) {
+                continue;
+            }
+            for (unsigned i = IR_BLOCK(ctx, b)->first; i < IR_BLOCK(ctx, b)->last; i++) {
+                const IRInstr *in = IR_INSTR(ctx, i);
+                IRValue operands[2] = {in->a, in->b};
+                int hoist = isPure(in) && hoisted[i] == 0 && (always[b] == stamp || (!mayTrap(ctx, in) && !mayOverflow(in)))
+                            && (in->kind != IR_LOAD || written[in->x] != stamp);
+                for (int k = 0; hoist && k < 2; k++) {
+                    unsigned t = operands[k].index - code->firstTmp;
+                    if (operands[k].kind == VAL_VAR) {
+                        hoist = (written[operands[k].index] != stamp);
+                    } else if (operands[k].kind == VAL_TEMP) {
+                        hoist = (invariant[t] == stamp || defBlock[t] == 0 || inLoop[defBlock[t] - 1] != stamp);
+                    }
+                }
+                if (!hoist) {
+                    continue;
+                }
+                invariant[in->dst - code->firstTmp] = stamp;
+                hoisted[i] = stamp;
+                if (loop->last != 0) {
+                    next[loop->last - 1] = i + 1;
+                } else {
+                    loop->hoisted = i + 1;
+                }
+                loop->last = i + 1;
+                moved++;
+            }
+        }
+        if (loop->hoisted == 0) {
+            continue;
+        }
+
+        // (4). Give the preheader a label, if jumps from outside the loop enter its header.
+        for (unsigned k = 0; k < IR_BLOCK(ctx, h)->preds; k++) {
+            unsigned p = code->preds[IR_BLOCK(ctx, h)->pred + k];
+            IRInstr *jump = lastInstr(ctx, p);
+            if (inLoop[p] != stamp && jump != NULL && (jump->kind == IR_GOTO || jump->kind == IR_BRANCH)
+                && jump->x == IR_BLOCK(ctx, h)->label) {
+                if (label[h] == 0) {
+                    label[h] = ++ctx->l;
+                    labels++;
+                }
+                jump->x = label[h] - 1;
+            }
+        }
+        loop->header = h + 1;
+    }
+
+    // (5). Lay out the code again, with each preheader before its header.
+    if (moved > 0) {
+        if ((instrs = malloc((code->count + labels) * sizeof(IRInstr))) == NULL) {
+            fprintf(stderr, "Error: hoistInvariants: Couldn't allocate code!\n");
+            exit(EXIT_FAILURE);
+        }
+        count = 0;
+        for (unsigned l = 0, b = 0; b < n; b++) {
+            for (unsigned i = IR_BLOCK(ctx, b)->first; i < IR_BLOCK(ctx, b)->last; i++) {
+                if (i == IR_BLOCK(ctx, b)->first) {
+                    if (label[b] != 0) {
+                        instrs[count++] = (IRInstr){.kind = IR_LABEL, .tt = UNDEFINED, .op = UNDEFINED, .dst = NIL, .x = label[b] - 1};
+                    }
+                    for (l = 0; l < loopCount; l++) {
+                        if (loops[l].header == b + 1) {
+                            for (unsigned j = loops[l].hoisted; j != 0; j = next[j - 1]) {
+                                instrs[count++] = *IR_INSTR(ctx, j - 1);
+                            }
+                        }
+                    }
+                }
+                if (hoisted[i] == 0) {
+                    instrs[count++] = *IR_INSTR(ctx, i);
+                }
+            }
+        }
+        free(code->instrs);
+        code->instrs = instrs;
+        code->count = code->size = count;
+        buildBlocks(ctx);
+    }
+    free(inLoop);
+    free(always);
+    free(written);
+    free(defBlock);
+    free(invariant);
+    free(next);
+    free(hoisted);
+    free(label);
+    free(loops);
+    free(members);
+    return (moved > 0);
+}
+
+/* LICM: Moves the computations a loop repeats with the same result into a
+ * preheader, run once before the loop is entered. Loops are found from their
+ * back edges: Jumps to a block dominating them, the header. An instruction is
+ * invariant if its operands are constants, variables and vectors the loop
+ * never assigns, and T-Labels assigned outside the loop or by invariants.
+ * Instructions which may fault or overflow an int are only moved from blocks
+ * run on every pass through the loop. Repeats until nothing moves, so invariants leave nested
+ * loops one at a time. */
+static void hoistLoopInvariants (CompileContext *ctx) {
+    while (hoistInvariants(ctx)) {
+        continue;
+    }
+}
+
+/* Dead code: Removes instructions assigning T-Labels that are never used,
+ * along with the instructions computing their operands, if only used there. */
+static void eliminateDeadCode (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    unsigned temps = ctx->t - code->firstTmp, *uses = newCounters(temps), *defs = newCounters(temps);
+    unsigned *stack = newCounters(code->count), top = 0;
+
+    // Count the uses of each T-Label, and find the instruction assigning it.
+    for (unsigned i = 0; i < code->count; i++) {
+        const IRInstr *in = IR_INSTR(ctx, i);
+        if (in->kind == IR_NOP) {
+            continue;
+        }
+        if (in->a.kind == VAL_TEMP) {
+            uses[in->a.index - code->firstTmp]++;
+        }
+        if (in->b.kind == VAL_TEMP) {
+            uses[in->b.index - code->firstTmp]++;
+        }
+        if (isPure(in)) {
+            defs[in->dst - code->firstTmp] = i;
+        }
+    }
+    for (unsigned i = 0; i < code->count; i++) {
+        if (isPure(IR_INSTR(ctx, i)) && uses[IR_INSTR(ctx, i)->dst - code->firstTmp] == 0) {
+            stack[top++] = i;
+        }
+    }
+
+    // Remove unused assignments, then any operands left unused.
+    while (top > 0) {
+        IRInstr *in = IR_INSTR(ctx, stack[--top]);
+        if (in->kind == IR_NOP || uses[in->dst - code->firstTmp] != 0) {
+            continue;
+        }
+        in->kind = IR_NOP;
+        IRValue operands[2] = {in->a, in->b};
+        for (int k = 0; k < 2; k++) {
+            if (operands[k].kind == VAL_TEMP && --uses[operands[k].index - code->firstTmp] == 0) {
+                stack[top++] = defs[operands[k].index - code->firstTmp];
+            }
+        }
+    }
+    free(uses);
+    free(defs);
+    free(stack);
+}
+
+/* Temps: Pools the T-Labels, so that T-Labels never live at the same time
+ * share a slot. A T-Label lives from its assignment to its last use in its
+ * home block, and through every block on a path from its assignment to a use
+ * elsewhere (found walking back from that use). Scanning the code in order,
+ * a T-Label takes a free slot of its token-type when its range starts, and
+ * frees it after its range ends. Must run last: T-Labels are renamed to their
+ * slots, and are no longer assigned once. */
+static void reuseTemps (CompileContext *ctx) {
+    IRCode *code = &ctx->code;
+    unsigned temps = ctx->t - code->firstTmp, points = 2 * code->count;
+    unsigned *useNext, *useBlock, used = 0, *mark, *stack, top, *starting, *ending, *idle[2], idles[2] = {0, 0};
+    Range *ranges, *r;
+
+    if (temps == 0) {
+        return;
+    }
+    if ((ranges = malloc(temps * sizeof(Range))) == NULL) {
+        fprintf(stderr, "Error: reuseTemps: Couldn't allocate live ranges!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned t = 0; t < temps; t++) {
+        ranges[t] = (Range){.lo = NIL, .hi = 0, .home = NIL, .tt = TT_INTEGER, .slot = NIL};
+    }
+    useNext = newCounters(2 * code->count);
+    useBlock = newCounters(2 * code->count);
+
+    // (1). Find the range of each T-Label within its home block, and its other uses.
+    for (unsigned b = 0; b < code->blockCount; b++) {
+        for (unsigned i = IR_BLOCK(ctx, b)->first; i < IR_BLOCK(ctx, b)->last; i++) {
+            const IRInstr *in = IR_INSTR(ctx, i);
+            if (in->kind == IR_NOP) {
+                continue;
+            }
+            IRValue operands[2] = {in->a, in->b};
+            for (int k = 0; k < 2; k++) {
+                if (operands[k].kind != VAL_TEMP) {
+                    continue;
+                }
+                r = &ranges[operands[k].index - code->firstTmp];
+                widen(r, 2 * readerOf(ctx, i));
+                if (r->home != b) {
+                    useBlock[used] = b;
+                    useNext[used] = r->uses;
+                    r->uses = ++used;
+                }
+            }
+            if (isPure(in)) {
+                r = &ranges[in->dst - code->firstTmp];
+                r->home = b;
+                r->tt = in->tt;
+                widen(r, 2 * i + 1);
+            }
+        }
+    }
+
+    // (2). Extend the ranges of T-Labels used outside their home block.
+    mark = newCounters(code->blockCount);
+    stack = newCounters(code->blockCount);
+    for (unsigned t = 0; t < temps; t++) {
+        r = &ranges[t];
+        top = 0;
+        for (unsigned u = r->uses; u != 0; u = useNext[u - 1]) {
+            unsigned b = useBlock[u - 1];
+            if (mark[b] != t + 1) {
+                mark[b] = t + 1;
+                widen(r, 2 * IR_BLOCK(ctx, b)->first);
+                stack[top++] = b;
+            }
+        }
+        while (top > 0) {
+            const IRBlock *block = IR_BLOCK(ctx, stack[--top]);
+            for (unsigned k = 0; k < block->preds; k++) {
+                unsigned p = code->preds[block->pred + k];
+                widen(r, 2 * IR_BLOCK(ctx, p)->last - 1);
+                if (p != r->home && mark[p] != t + 1) {
+                    mark[p] = t + 1;
+                    widen(r, 2 * IR_BLOCK(ctx, p)->first);
+                    stack[top++] = p;
+                }
+            }
+        }
+    }
+
+    // (3). Hand out the slots in order of the ranges.
+    starting = newCounters(points);
+    ending = newCounters(points);
+    for (unsigned t = 0; t < temps; t++) {
+        if ((r = &ranges[t])->lo != NIL) {
+            r->starting = starting[r->lo];
+            starting[r->lo] = t + 1;
+            r->ending = ending[r->hi];
+            ending[r->hi] = t + 1;
+        }
+    }
+    idle[0] = newCounters(temps);
+    idle[1] = newCounters(temps);
+    for (unsigned p = 0; p < points; p++) {
+        for (unsigned t = starting[p]; t != 0; t = ranges[t - 1].starting) {
+            r = &ranges[t - 1];
+            int k = (r->tt == TT_REAL);
+            r->slot = (idles[k] > 0 ? idle[k][--idles[k]] : addSlot(ctx, r->tt));
+        }
+        for (unsigned t = ending[p]; t != 0; t = ranges[t - 1].ending) {
+            r = &ranges[t - 1];
+            int k = (r->tt == TT_REAL);
+            idle[k][idles[k]++] = r->slot;
+        }
+    }
+
+    // (4). Rename the T-Labels to their slots.
+    for (unsigned i = 0; i < code->count; i++) {
+        IRInstr *in = IR_INSTR(ctx, i);
+        if (in->kind == IR_NOP) {
+            continue;
+        }
+        if (in->a.kind == VAL_TEMP) {
+            in->a.index = ranges[in->a.index - code->firstTmp].slot;
+        }
+        if (in->b.kind == VAL_TEMP) {
+            in->b.index = ranges[in->b.index - code->firstTmp].slot;
+        }
+        if (isPure(in)) {
+            in->dst = ranges[in->dst - code->firstTmp].slot;
+        }
+    }
+    free(ranges);
+    free(useNext);
+    free(useBlock);
+    free(mark);
+    free(stack);
+    free(starting);
+    free(ending);
+    free(idle[0]);
+    free(idle[1]);
+}
+
+/*
+***************************************************************************
+*                                Routines
+***************************************************************************
+*/
+
+/* Passes, in the order they run */
+static const Pass passes[] = {
+    {"copies",      1, propagateCopies},
+    {"peephole",    1, fuseCompares},
+    {"indices",     1, foldIndices},
+    {"jumps",       1, simplifyJumps},
+    {"cse",         2, eliminateCommonSubexpressions},
+    {"licm",        2, hoistLoopInvariants},
+    {"dead-code",   1, eliminateDeadCode},
+    {"temps",       1, reuseTemps}
+};
+
+/* Runs the passes of the optimization level of the compilation over its code */
+void optimizeCode (CompileContext *ctx) {
+    if (ctx->options.level == 0 || ctx->code.count == 0) {
+        return;
+    }
+    buildBlocks(ctx);
+    for (unsigned p = 0; p < sizeof(passes) / sizeof(passes[0]); p++) {
+        if (passes[p].level <= (unsigned)ctx->options.level) {
+            passes[p].run(ctx);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#if !defined(PASSES_H)
+#define PASSES_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+
+/*
+***************************************************************************
+*                              Optimizer                                  *
+* AUTHORS: Charles Randolph, Joe Jones.                                   *
+* SNUMBERS: s2897318, s2990652.                                           *
+***************************************************************************
+*/
+
+/*
+ * The optimizer runs a fixed list of passes over the three-address code (see
+ * ir.h) before it is emitted. Each pass belongs to an optimization level, and
+ * runs at that level and above (-O<Level>):
+ *   -O0: None. The code is emitted as generated.
+ *   -O1: Cheap local clean-ups, such as removing redundant jumps and labels,
+ *        forwarding copies, fusing compares into branches and removing dead
+ *        temporaries, and pooling the temporaries left.
+ *   -O2: Also the passes which analyze the control-flow graph as a whole.
+ * Levels above 2 run the -O2 passes.
+ *
+ * Passes find the basic blocks built (see buildBlocks), and leave them built.
+ * Instructions are removed by turning them into IR_NOPs.
+ */
+
+/*
+***************************************************************************
+*                            Type Definitions
+***************************************************************************
+*/
+
+/* An optimization pass */
+typedef struct {
+    const char *name;               // Name of the pass.
+    unsigned level;                 // Lowest optimization level running it.
+    void (*run)(CompileContext *);  // Rewrites the code of a compilation.
+} Pass;
+
+/*
+***************************************************************************
+*                           Routine Prototypes
+***************************************************************************
+*/
+
+/* Runs the passes of the optimization level of the compilation over its code */
+void optimizeCode (CompileContext *ctx);
+
+#endif
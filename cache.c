@@ -0,0 +1,344 @@
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "compile.h"
+
+/*
+***************************************************************************
+*                  Internal Symbolic Constants & Variables
+***************************************************************************
+*/
+
+/* Version stamp hashed into every key. Rebuilding mpc invalidates the cache */
+#define CACHE_VERSION           MPC_VERSION " " __DATE__ " " __TIME__
+
+/* FNV-1a (64 bit) parameters */
+#define FNV_OFFSET              0xcbf29ce484222325ULL
+#define FNV_PRIME               0x100000001b3ULL
+
+/* Multiplier of the check hash (odd, from the golden ratio) */
+#define CHECK_PRIME             0x9e3779b97f4a7c15ULL
+
+/* An entry found while scanning the cache directory */
+typedef struct {
+    char *name;
+    size_t size;
+    struct timespec used;
+} CacheEntry;
+
+/* Cache directory (NULL if disabled) and bound on its size */
+static char *cacheDir;
+static size_t cacheLimit;
+
+/* Hits and misses of this process. Shared by all compiling threads */
+static unsigned long hits, misses;
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+***************************************************************************
+*                           Internal Routines
+***************************************************************************
+*/
+
+/* Returns the FNV-1a hash of `n` bytes of `data`, continuing from `h`. */
+static unsigned long long fnv (unsigned long long h, const void *data, size_t n) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; i++) {
+        h = (h ^ p[i]) * FNV_PRIME;
+    }
+    return h;
+}
+
+/* Returns the check hash of `n` bytes of `data`, continuing from `h`: Each
+ * byte is mixed into a rotated state, unlike FNV-1a, so that sources whose
+ * FNV-1a hashes collide are told apart. */
+static unsigned long long check (unsigned long long h, const void *data, size_t n) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; i++) {
+        h = (((h << 5) | (h >> 59)) ^ p[i]) * CHECK_PRIME;
+    }
+    return h;
+}
+
+/* Allocates the path of `name` within the cache directory. */
+static char *cachePath (const char *name) {
+    char *path;
+    if ((path = malloc(strlen(cacheDir) + strlen(name) + 2)) == NULL) {
+        fprintf(stderr, "Error: cachePath: Couldn't allocate path!\n");
+        exit(EXIT_FAILURE);
+    }
+    sprintf(path, "%s/%s", cacheDir, name);
+    return path;
+}
+
+/* Allocates the path of the entry of `key` and `suffix`. */
+static char *entryPath (CacheKey key, const char *suffix) {
+    char name[64];
+    snprintf(name, sizeof(name), "%016llx%s", key.name, suffix);
+    return cachePath(name);
+}
+
+/* Counts a hit (nonzero) or a miss. */
+static void countLookup (int hit) {
+    pthread_mutex_lock(&statsLock);
+    *(hit ? &hits : &misses) += 1;
+    pthread_mutex_unlock(&statsLock);
+}
+
+/* Opens and exclusively locks the statistics file, reading its counters.
+ * Returns the descriptor, or -1 on error. */
+static int lockStats (unsigned long *h, unsigned long *m) {
+    char *path = cachePath(CACHE_STATS_FILE), text[64];
+    ssize_t n;
+    int fd;
+
+    *h = *m = 0;
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    free(path);
+    if (fd < 0 || flock(fd, LOCK_EX) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    if ((n = read(fd, text, sizeof(text) - 1)) > 0) {
+        text[n] = '\0';
+        sscanf(text, "%lu %lu", h, m);
+    }
+    return fd;
+}
+
+/* Returns nonzero if `name` is a cache entry (and not statistics or a partial store). */
+static int isEntry (const char *name) {
+    return (*name != '.' && strcmp(name, CACHE_STATS_FILE) != 0 && strncmp(name, "tmp.", 4) != 0);
+}
+
+/* Orders entries from least to most recently used. */
+static int compareEntries (const void *a, const void *b) {
+    const struct timespec *x = &((const CacheEntry *)a)->used, *y = &((const CacheEntry *)b)->used;
+    if (x->tv_sec != y->tv_sec) {
+        return (x->tv_sec < y->tv_sec ? -1 : 1);
+    }
+    return (x->tv_nsec < y->tv_nsec ? -1 : (x->tv_nsec > y->tv_nsec));
+}
+
+/* Lists the cache entries, storing their count in `count` and total size in `total`. */
+static CacheEntry *scanCache (unsigned *count, size_t *total) {
+    CacheEntry *entries = NULL;
+    struct dirent *d;
+    struct stat st;
+    unsigned size = 0;
+    char *path;
+    DIR *dir;
+
+    *count = 0;
+    *total = 0;
+    if ((dir = opendir(cacheDir)) == NULL) {
+        return NULL;
+    }
+    while ((d = readdir(dir)) != NULL) {
+        if (!isEntry(d->d_name)) {
+            continue;
+        }
+        path = cachePath(d->d_name);
+        if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+            if (*count == size) {
+                size = 2 * size + 16;
+                if ((entries = realloc(entries, size * sizeof(CacheEntry))) == NULL) {
+                    fprintf(stderr, "Error: scanCache: List reallocation failed!\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            entries[*count] = (CacheEntry){.name = path, .size = st.st_size, .used = st.st_mtim};
+            *total += st.st_size;
+            (*count)++;
+        } else {
+            free(path);
+        }
+    }
+    closedir(dir);
+    return entries;
+}
+
+/* Removes the least recently used entries until the cache fits its limit. */
+static void evictCache (void) {
+    unsigned count, i;
+    size_t total;
+    CacheEntry *entries = scanCache(&count, &total);
+
+    qsort(entries, count, sizeof(CacheEntry), compareEntries);
+    for (i = 0; i < count; i++) {
+        if (total > cacheLimit && (unlink(entries[i].name) == 0 || errno == ENOENT)) {
+            total -= entries[i].size;
+        }
+        free(entries[i].name);
+    }
+    free(entries);
+}
+
+/*
+***************************************************************************
+*                                Routines
+***************************************************************************
+*/
+
+/* Opens the cache in directory `dir` (created if missing), keeping the
+ * total size of its entries within `limit` bytes. Returns nonzero on error. */
+int openCache (const char *dir, size_t limit) {
+    struct stat st;
+
+    if (mkdir(dir, 0755) != 0 && (errno != EEXIST || stat(dir, &st) != 0 || !S_ISDIR(st.st_mode))) {
+        fprintf(stderr, "mpc: Couldn't create cache directory \"%s\"!\n", dir);
+        return 1;
+    }
+    if ((cacheDir = strdup(dir)) == NULL) {
+        fprintf(stderr, "Error: openCache: Couldn't allocate path!\n");
+        exit(EXIT_FAILURE);
+    }
+    cacheLimit = limit;
+    hits = misses = 0;
+    return 0;
+}
+
+/* Returns nonzero if a cache is open. */
+int cacheEnabled (void) {
+    return (cacheDir != NULL);
+}
+
+/* Returns the key of `n` bytes of source compiled with the given flags. The
+ * compiler version is part of every key. */
+CacheKey cacheKey (const char *source, size_t n, const char *flags) {
+    CacheKey key = {.name = FNV_OFFSET, .check = 0, .length = n};
+
+    // Terminators keep the version, flags and source from running together.
+    key.name = fnv(key.name, CACHE_VERSION, sizeof(CACHE_VERSION));
+    key.name = fnv(key.name, flags, strlen(flags) + 1);
+    key.name = fnv(key.name, source, n);
+    key.check = check(key.check, CACHE_VERSION, sizeof(CACHE_VERSION));
+    key.check = check(key.check, flags, strlen(flags) + 1);
+    key.check = check(key.check, source, n);
+    return key;
+}
+
+/* Looks up the entry of `key` and `suffix`. On a hit, the output is written to
+ * file `out` and the diagnostics to `errfp`. Returns nonzero on a miss. */
+int cacheLookup (CacheKey key, const char *suffix, const char *out, FILE *errfp) {
+    char *path = entryPath(key, suffix), *data = NULL;
+    unsigned long long sum;
+    size_t length, n, diagSize;
+    struct stat st;
+    FILE *fp, *outfp;
+    int miss = 1;
+
+    if ((fp = fopen(path, "r")) == NULL) {
+        free(path);
+        countLookup(0);
+        return 1;
+    }
+
+    // Verify the entry is of this source, and complete, before producing any output.
+    if (fscanf(fp, CACHE_HEADER_FORMAT, &length, &sum, &n, &diagSize) == 4 && length == key.length &&
+        sum == key.check && fstat(fileno(fp), &st) == 0 &&
+        (size_t)st.st_size == ftell(fp) + n + diagSize && (data = malloc(n + diagSize + 1)) != NULL &&
+        fread(data, 1, n + diagSize, fp) == n + diagSize) {
+        if ((outfp = fopen(out, "w")) != NULL) {
+            miss = (fwrite(data, 1, n, outfp) != n);
+            miss |= (fclose(outfp) != 0);
+        }
+        if (!miss) {
+            fwrite(data + n, 1, diagSize, errfp);
+
+            // Mark the entry as most recently used.
+            utimensat(AT_FDCWD, path, NULL, 0);
+        }
+    }
+
+    fclose(fp);
+    free(data);
+    free(path);
+    countLookup(!miss);
+    return miss;
+}
+
+/* Stores `n` bytes of output and `diagSize` bytes of diagnostics as the entry
+ * of `key` and `suffix`. Failures are ignored: The cache is only an aid. */
+void cacheStore (CacheKey key, const char *suffix, const char *data, size_t n,
+    const char *diag, size_t diagSize) {
+    char *tmp = cachePath("tmp.XXXXXX"), *path = entryPath(key, suffix);
+    int fd, err;
+    FILE *fp;
+
+    // Write to a private file and rename it, so readers never see partial entries.
+    if ((fd = mkstemp(tmp)) < 0) {
+        free(tmp);
+        free(path);
+        return;
+    }
+    if ((fp = fdopen(fd, "w")) == NULL) {
+        close(fd);
+        err = 1;
+    } else {
+        err = (fprintf(fp, CACHE_HEADER_FORMAT, key.length, key.check, n, diagSize) < 0);
+        err |= (fwrite(data, 1, n, fp) != n);
+        err |= (fwrite(diag, 1, diagSize, fp) != diagSize);
+        err |= (fclose(fp) != 0);
+    }
+    if (err || rename(tmp, path) != 0) {
+        unlink(tmp);
+    }
+    free(tmp);
+    free(path);
+}
+
+/* Adds the hits and misses of this process to the statistics file, evicts the
+ * least recently used entries beyond the size limit and closes the cache. */
+void closeCache (void) {
+    unsigned long h, m;
+    char text[64];
+    int fd;
+
+    if (cacheDir == NULL) {
+        return;
+    }
+    if ((fd = lockStats(&h, &m)) >= 0) {
+        snprintf(text, sizeof(text), "%lu %lu\n", h + hits, m + misses);
+        if (ftruncate(fd, 0) != 0 || pwrite(fd, text, strlen(text), 0) < 0) {
+            fprintf(stderr, "Warning: closeCache: Couldn't update statistics!\n");
+        }
+        evictCache();
+        close(fd);
+    }
+    free(cacheDir);
+    cacheDir = NULL;
+}
+
+/* Prints the statistics, entry count and size of the cache to `fp`. */
+void printCacheStats (FILE *fp) {
+    unsigned long h, m;
+    unsigned count;
+    size_t total;
+    CacheEntry *entries;
+    int fd;
+
+    if ((fd = lockStats(&h, &m)) < 0) {
+        fprintf(stderr, "mpc: Couldn't read cache statistics!\n");
+        return;
+    }
+    entries = scanCache(&count, &total);
+    close(fd);
+    for (unsigned i = 0; i < count; i++) {
+        free(entries[i].name);
+    }
+    free(entries);
+
+    fprintf(fp, "Cache: %s\n", cacheDir);
+    fprintf(fp, "Hits: %lu, misses: %lu (%.1f%% hit rate)\n", h, m,
+        (h + m > 0 ? 100.0 * h / (h + m) : 0.0));
+    fprintf(fp, "Entries: %u, size: %zu of %zu bytes\n", count, total, cacheLimit);
+}
@@ -0,0 +1,91 @@
+#if !defined(CACHE_H)
+#define CACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+***************************************************************************
+*                      Content-Addressed Compile Cache                    *
+* AUTHORS: Charles Randolph, Joe Jones.                                   *
+* SNUMBERS: s2897318, s2990652.                                           *
+***************************************************************************
+*/
+
+/*
+***************************************************************************
+*                  Symbolic Constants & Global Variables
+***************************************************************************
+*/
+
+/* Default bound on the total size of the cache entries */
+#define CACHE_DEFAULT_LIMIT     (64 << 20)
+
+/* Name of the statistics file within the cache directory */
+#define CACHE_STATS_FILE        "stats"
+
+/* Entries are stored as "<key name><suffix>" within the cache directory. Each
+ * holds a header line, the cached output and the diagnostics printed by the
+ * compilation which produced it. The header repeats the source length and
+ * check hash of the key, so an entry whose name collides is not mistaken for
+ * a hit:
+ *   "<source length> <check> <output length> <diagnostics length>\n"
+ *   <output bytes> <diagnostic bytes>
+ */
+#define CACHE_HEADER_FORMAT     "%zu %llx %zu %zu\n"
+
+/* Suffix of entries holding generated C */
+#define CACHE_C                 ".c"
+
+/* Suffix of entries holding native executables */
+#define CACHE_NATIVE            ".out"
+
+/*
+***************************************************************************
+*                            Type Definitions
+***************************************************************************
+*/
+
+/* Key of a compilation: A hash naming its entry, and the source length and a
+ * second, unrelated hash which the entry must match */
+typedef struct {
+    unsigned long long name;    // FNV-1a hash of version, flags and source.
+    unsigned long long check;   // Multiply-rotate hash of the same bytes.
+    size_t length;              // Source length.
+} CacheKey;
+
+/*
+***************************************************************************
+*                           Routine Prototypes
+***************************************************************************
+*/
+
+/* Opens the cache in directory `dir` (created if missing), keeping the
+ * total size of its entries within `limit` bytes. Returns nonzero on error. */
+int openCache (const char *dir, size_t limit);
+
+/* Returns nonzero if a cache is open. */
+int cacheEnabled (void);
+
+/* Returns the key of `n` bytes of source compiled with the given flags. The
+ * compiler version is part of every key. */
+CacheKey cacheKey (const char *source, size_t n, const char *flags);
+
+/* Looks up the entry of `key` and `suffix`. On a hit, the output is written to
+ * file `out` and the diagnostics to `errfp`. An entry of another source is a
+ * miss. Returns nonzero on a miss. */
+int cacheLookup (CacheKey key, const char *suffix, const char *out, FILE *errfp);
+
+/* Stores `n` bytes of output and `diagSize` bytes of diagnostics as the entry
+ * of `key` and `suffix`. Failures are ignored: The cache is only an aid. */
+void cacheStore (CacheKey key, const char *suffix, const char *data, size_t n,
+    const char *diag, size_t diagSize);
+
+/* Adds the hits and misses of this process to the statistics file, evicts the
+ * least recently used entries beyond the size limit and closes the cache. */
+void closeCache (void);
+
+/* Prints the statistics, entry count and size of the cache to `fp`. */
+void printCacheStats (FILE *fp);
+
+#endif
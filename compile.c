@@ -0,0 +1,409 @@
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "compile.h"
+#include "mpascal.tab.h"    // Parser (and the tables it depends on).
+#include "mpio.h"           // IO Handler (code generation).
+#include "irgen.h"          // Intermediate-Code Generator.
+#include "cache.h"          // Compile cache.
+#include "stats.h"          // Compilation statistics.
+
+/*
+***************************************************************************
+*                  Internal Symbolic Constants & Variables
+***************************************************************************
+*/
+
+/* Routines local to lex.yy.c */
+extern int yylex_init_extra (CompileContext *ctx, yyscan_t *scanner);
+extern void yyset_in (FILE *fp, yyscan_t scanner);
+extern void setScannerSource (const char *source, size_t length, yyscan_t scanner);
+extern int yylex_destroy (yyscan_t scanner);
+extern int yylex (YYSTYPE *lvalp, yyscan_t scanner);
+
+/* Outcomes of compiling a file */
+#define COMPILE_OK              0
+#define COMPILE_FAILED          1
+#define COMPILE_UNWRITTEN       2
+#define COMPILE_UNBUILT         3
+
+/*
+***************************************************************************
+*                           Internal Routines
+***************************************************************************
+*/
+
+/* Returns the flags which affect the output or the diagnostics, including
+ * the native build settings (if any). The string must be freed. */
+static char *compileFlags (CompileContext *ctx, const NativeOptions *native) {
+    static const char *flags[] = {"", "c", "d", "cd", "q", "cq", "dq", "cdq"};
+    const CompileOptions *o = &ctx->options;
+    const char *mode = flags[(o->color != 0) | (o->debug != 0) << 1 | (o->quiet != 0) << 2];
+    size_t n = strlen(mode) + 32;
+    char *s;
+
+    if (native != NULL) {
+        n += strlen(native->cc) + strlen(native->flags);
+    }
+    if ((s = malloc(n)) == NULL) {
+        fprintf(stderr, "Error: compileFlags: Couldn't allocate flags!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (native == NULL) {
+        sprintf(s, "%s|-O%d", mode, o->level);
+    } else {
+        sprintf(s, "%s|%s|%s|-O%d", mode, native->cc, native->flags, native->level);
+    }
+    return s;
+}
+
+/* Returns the shell command compiling C from standard input to executable `out`.
+ * The output name is quoted, the compiler and its flags are taken as-is. The
+ * string must be freed. */
+static char *nativeCommand (const NativeOptions *native, const char *out) {
+    char *command, *p;
+
+    // Every quote in the name becomes '\'' (four characters).
+    if ((command = malloc(strlen(native->cc) + strlen(native->flags) + 4 * strlen(out) + 32)) == NULL) {
+        fprintf(stderr, "Error: nativeCommand: Couldn't allocate command!\n");
+        exit(EXIT_FAILURE);
+    }
+    p = command + sprintf(command, "%s -x c -O%d %s -o '", native->cc, native->level, native->flags);
+    for (; *out != '\0'; out++) {
+        p = (*out == '\'' ? stpcpy(p, "'\\''") : (*p = *out, p + 1));
+    }
+    strcpy(p, "' -");
+    return command;
+}
+
+/* Records the final table sizes, label counts, tree and code sizes in the statistics. */
+static void recordTableUsage (CompileContext *ctx) {
+    CompileStats *stats = &ctx->stats;
+    stats->strUsed = stringTableUsage(ctx, &stats->strSize);
+    stats->numUsed = numberTableUsage(ctx, &stats->numSize);
+    symbolTableUsage(ctx, &stats->symEntries, &stats->symSlots, &stats->symMeanProbe, &stats->symLongest);
+    stats->temps = getTmp(ctx);
+    stats->labels = getLbl(ctx);
+    stats->astBuilt = ctx->ast.built;
+    stats->astPeak = ctx->ast.peak;
+    stats->irBuilt = ctx->code.built;
+    stats->irEmitted = ctx->code.emitted;
+    stats->irDeclared = ctx->code.declared;
+}
+
+/* Parses the source with the push parser, one token at a time. The generated
+ * code is flushed whenever a statement or declaration is complete. Returns
+ * the status of the parse (as yyparse). */
+static int pushParse (CompileContext *ctx, yyscan_t scanner) {
+    yypstate *ps;
+    YYSTYPE value;
+    int token, status;
+
+    if ((ps = yypstate_new()) == NULL) {
+        fprintf(stderr, "Error: pushParse: Couldn't allocate parser state!\n");
+        exit(EXIT_FAILURE);
+    }
+    do {
+        token = yylex(&value, scanner);
+        status = yypush_parse(ps, token, &value, scanner, ctx);
+        if (token == MP_SCOLON || token == MP_END || token == MP_EOF) {
+            IN_PHASE(ctx, PHASE_OUTPUT, flushIRStream(ctx));
+        }
+    } while (status == YYPUSH_MORE);
+    yypstate_delete(ps);
+    return status;
+}
+
+/* Compiles the source read from `fp`, or the `n` bytes at `source` if `fp`
+ * is NULL, into the open IR buffer or stream of `ctx`. Tokens are pushed
+ * to the parser if `push` is set. Returns nonzero on failure. */
+static int parseSource (CompileContext *ctx, FILE *fp, const char *source, size_t n, FILE *errfp, int push) {
+    yyscan_t scanner;
+    int failed;
+
+    // Initialize compilation state and supporting tables.
+    initDebug(ctx, errfp);
+    initStringTable(ctx);
+    initNumberTable(ctx);
+    initVarListArena(ctx);
+    initAst(ctx, push);
+    resetLabels(ctx);
+    initCode(ctx);
+    if (yylex_init_extra(ctx, &scanner)) {
+        fprintf(stderr, "mpc: Couldn't allocate compiler state!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (fp != NULL) {
+        yyset_in(fp, scanner);
+        setSourceStream(ctx, fp);
+    } else {
+        setScannerSource(source, n, scanner);
+        setSourceText(ctx, source, n);
+    }
+
+    // Perform Semantic Analysis while building the syntax tree, and generate IR from it
+    // (statement by statement while parsing, if pushed).
+    enterPhase(ctx, PHASE_PARSE);
+    failed = ((push ? pushParse(ctx, scanner) : yyparse(scanner, ctx)) != 0 || ctx->debug.isError != 0);
+    enterPhase(ctx, PHASE_SETUP);
+    if (ctx->options.stats) {
+        recordTableUsage(ctx);
+    }
+
+    // Drop all symbols and Flex memory.
+    freeSymbolTables(ctx);
+    yylex_destroy(scanner);
+
+    return failed;
+}
+
+/* Reads all of `fp` into a new buffer, storing its length in `n`. */
+static char *readSource (FILE *fp, size_t *n) {
+    size_t size = 4096;
+    char *source = NULL;
+
+    *n = 0;
+    do {
+        size *= 2;
+        if ((source = realloc(source, size)) == NULL) {
+            fprintf(stderr, "Error: readSource: Buffer reallocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        *n += fread(source + *n, 1, size - *n, fp);
+    } while (*n == size);
+    return source;
+}
+
+/* Returns the size of the mapping of a source of `n` bytes: At least one
+ * page beyond the source, so that the source is followed by a NUL byte. */
+static size_t mappingSize (size_t n) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    return (n / page + 1) * page;
+}
+
+/* Maps the regular file open in `fp` into memory, storing its length in
+ * `n`. Returns NULL if the file can't be mapped, or is empty. */
+static char *mapSource (FILE *fp, size_t *n) {
+    struct stat st;
+    char *map;
+
+    if (fstat(fileno(fp), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        return NULL;
+    }
+    *n = st.st_size;
+
+    // Reserve zeroed pages, then map the file over the start of them.
+    map = mmap(NULL, mappingSize(*n), PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    if (mmap(map, *n, PROT_READ, MAP_PRIVATE | MAP_FIXED, fileno(fp), 0) == MAP_FAILED) {
+        munmap(map, mappingSize(*n));
+        return NULL;
+    }
+    madvise(map, *n, MADV_SEQUENTIAL);
+    return map;
+}
+
+/* Compiles the source in `fp`, or the `n` bytes at `source` if non-NULL, to
+ * `out` without the cache. */
+static int compileDirect (CompileContext *ctx, FILE *fp, const char *source, size_t n, const char *out, const NativeOptions *native, FILE *errfp) {
+    char *command;
+    int failed;
+
+    if (source != NULL ? compileBuffer(ctx, source, n, errfp) : compileStream(ctx, fp, errfp)) {
+        return COMPILE_FAILED;
+    }
+    if (native == NULL) {
+        IN_PHASE(ctx, PHASE_OUTPUT, failed = writeIRFile(ctx, out));
+        return (failed ? COMPILE_UNWRITTEN : COMPILE_OK);
+    }
+    command = nativeCommand(native, out);
+    IN_PHASE(ctx, PHASE_OUTPUT, failed = pipeIRBuffer(ctx, command));
+    free(command);
+    return (failed ? COMPILE_UNBUILT : COMPILE_OK);
+}
+
+/* Compiles the source in `fp`, or the `n` bytes at `mapped` if non-NULL,
+ * to `out` through the cache. On a miss, the source is compiled from memory
+ * and a successful result stored along with its diagnostics, which are
+ * replayed on later hits. */
+static int compileCached (CompileContext *ctx, FILE *fp, const char *mapped, size_t n, const char *out, const NativeOptions *native, FILE *errfp) {
+    const char *suffix = (native == NULL ? CACHE_C : CACHE_NATIVE), *code;
+    char *diag = NULL, *source = NULL, *flags, *binary;
+    size_t diagSize = 0, codeSize;
+    CacheKey key;
+    FILE *diagfp, *binfp;
+    int result;
+
+    // Read the source, unless mapped. Reading leaves room for a NUL byte.
+    if (mapped == NULL) {
+        mapped = source = readSource(fp, &n);
+        source[n] = '\0';
+    }
+    flags = compileFlags(ctx, native);
+    key = cacheKey(mapped, n, flags);
+    free(flags);
+    IN_PHASE(ctx, PHASE_OUTPUT, result = cacheLookup(key, suffix, out, errfp));
+    if (result == 0) {
+        if (native != NULL) {
+            chmod(out, 0755);
+        }
+        ctx->stats.cached = 1;
+        free(source);
+        return COMPILE_OK;
+    }
+
+    if ((diagfp = open_memstream(&diag, &diagSize)) == NULL) {
+        fprintf(stderr, "Error: compileCached: Couldn't open memory stream!\n");
+        exit(EXIT_FAILURE);
+    }
+    result = compileDirect(ctx, NULL, mapped, n, out, native, diagfp);
+    fclose(diagfp);
+
+    // Store the generated C, or read back the executable.
+    fwrite(diag, 1, diagSize, errfp);
+    enterPhase(ctx, PHASE_OUTPUT);
+    if (result == COMPILE_OK && native == NULL && (code = getIRBuffer(ctx, &codeSize)) != NULL) {
+        cacheStore(key, suffix, code, codeSize, diag, diagSize);
+    }
+    if (result == COMPILE_OK && native != NULL && (binfp = fopen(out, "r")) != NULL) {
+        binary = readSource(binfp, &codeSize);
+        cacheStore(key, suffix, binary, codeSize, diag, diagSize);
+        free(binary);
+        fclose(binfp);
+    }
+    enterPhase(ctx, PHASE_SETUP);
+    free(diag);
+    free(source);
+    return result;
+}
+
+/*
+***************************************************************************
+*                                Routines
+***************************************************************************
+*/
+
+/* Initializes an empty compilation context with the given options. A context
+ * holds all state of a compilation, so each thread compiles on its own. */
+void initCompileContext (CompileContext *ctx, const CompileOptions *options) {
+    memset(ctx, 0, sizeof(CompileContext));
+    ctx->options = *options;
+}
+
+/* Compiles the source read from `fp` on context `ctx`. All diagnostics are
+ * written to `errfp`. On success, the generated C is left in the IR buffer
+ * of the context (see mpio.h) until its next compilation. The context keeps
+ * its allocations for the next compilation. Returns nonzero on failure. */
+int compileStream (CompileContext *ctx, FILE *fp, FILE *errfp) {
+    if (openIRBuffer(ctx)) {
+        fprintf(stderr, "mpc: Couldn't allocate compiler state!\n");
+        exit(EXIT_FAILURE);
+    }
+    return parseSource(ctx, fp, NULL, 0, errfp, 0);
+}
+
+/* Compiles the `n` bytes of source at `source` as compileStream does. The
+ * byte after them must be NUL. The source must stay unchanged until the
+ * compilation returns. Returns nonzero on failure. */
+int compileBuffer (CompileContext *ctx, const char *source, size_t n, FILE *errfp) {
+    if (openIRBuffer(ctx)) {
+        fprintf(stderr, "mpc: Couldn't allocate compiler state!\n");
+        exit(EXIT_FAILURE);
+    }
+    return parseSource(ctx, NULL, source, n, errfp, 0);
+}
+
+/* Compiles the source read from file descriptor `in` while it arrives,
+ * writing the generated C to file descriptor `out` statement by statement.
+ * Neither the source nor the C is held in memory in full. As output can't
+ * be taken back, a failed compilation ends it in an #error directive.
+ * All diagnostics are written to `errfp`. Returns nonzero on failure. */
+int compileFd (CompileContext *ctx, int in, int out, FILE *errfp) {
+    FILE *fp;
+    int failed, fd;
+
+    // Time the whole compilation (see stats.h).
+    resetStats(ctx);
+
+    // The scanner reads a duplicate, so closing it leaves `in` open.
+    if ((fd = dup(in)) < 0 || (fp = fdopen(fd, "r")) == NULL || openIRStream(ctx, out)) {
+        fprintf(stderr, "mpc: Couldn't allocate compiler state!\n");
+        exit(EXIT_FAILURE);
+    }
+    failed = parseSource(ctx, fp, NULL, 0, errfp, 1);
+    fclose(fp);
+
+    enterPhase(ctx, PHASE_OUTPUT);
+    if (failed) {
+        fprintf(ctx->ir.fp, "#error \"mpc: compilation failed\"\n");
+    }
+    if (fflush(ctx->ir.fp) != 0) {
+        fprintf(errfp, "mpc: Couldn't write generated code!\n");
+        failed = 1;
+    }
+    closeIRBuffer(ctx);
+    enterPhase(ctx, PHASE_SETUP);
+    return failed;
+}
+
+/* Compiles the source file `in` into the C file `out`, or into the native
+ * executable `out` if `native` is non-NULL. All diagnostics are written to
+ * `errfp`. Unchanged sources are taken from the cache, if open.
+ * Returns nonzero on failure. */
+int compileFile (CompileContext *ctx, const char *in, const char *out, const NativeOptions *native, FILE *errfp) {
+    char *mapped = NULL;
+    size_t n = 0;
+    FILE *fp;
+    int result;
+
+    // Time the whole compilation (see stats.h).
+    resetStats(ctx);
+
+    // Open the source file for the scanner.
+    if ((fp = fopen(in, "r")) == NULL) {
+        fprintf(errfp, "mpc: Couldn't open \"%s\"!\n", in);
+        return 1;
+    }
+
+    // In mapped mode, the scanner reads the file in place. Files that can't
+    // be mapped are read as usual.
+    if (ctx->options.mapped) {
+        mapped = mapSource(fp, &n);
+    }
+
+    // Only write out the IR (or build it) if the program is valid.
+    if (cacheEnabled()) {
+        result = compileCached(ctx, fp, mapped, n, out, native, errfp);
+    } else {
+        result = compileDirect(ctx, fp, mapped, n, out, native, errfp);
+    }
+    if (mapped != NULL) {
+        munmap(mapped, mappingSize(n));
+    }
+    if (result == COMPILE_FAILED) {
+        fprintf(errfp, "mpc: Compilation of \"%s\" failed at semantic stage!\n", in);
+    } else if (result == COMPILE_UNWRITTEN) {
+        fprintf(errfp, "mpc: Couldn't write \"%s\"!\n", out);
+    } else if (result == COMPILE_UNBUILT) {
+        fprintf(errfp, "mpc: C compiler \"%s\" failed to build \"%s\"!\n", native->cc, out);
+    }
+
+    fclose(fp);
+    enterPhase(ctx, PHASE_SETUP);
+    return (result != COMPILE_OK);
+}
+
+/* Frees all memory held by the compilation context. */
+void freeCompileContext (CompileContext *ctx) {
+    closeIRBuffer(ctx);
+    freeNumberTable(ctx);
+    freeStringTable(ctx);
+    freeSymbolTables(ctx);
+    freeVarListArena(ctx);
+    freeAst(ctx);
+    freeCode(ctx);
+    freeDebug(ctx);
+}
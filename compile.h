@@ -0,0 +1,77 @@
+#if !defined(COMPILE_H)
+#define COMPILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "context.h"        // Compilation context.
+
+/*
+***************************************************************************
+*                            Compilation Driver                           *
+* AUTHORS: Charles Randolph, Joe Jones.                                   *
+* SNUMBERS: s2897318, s2990652.                                           *
+***************************************************************************
+*/
+
+/*
+***************************************************************************
+*                  Symbolic Constants & Global Variables
+***************************************************************************
+*/
+
+/* Compiler version. Part of every compile cache key */
+#define MPC_VERSION             "1.2"
+
+/* Default C compiler for native builds (overridden by $CC) */
+#define MPC_DEFAULT_CC          "cc"
+
+/* Default optimization level of native builds */
+#define MPC_DEFAULT_LEVEL       2
+
+/* Settings of a native build. The generated C is piped to:
+ *   <cc> -x c -O<level> <flags> -o <out> - */
+typedef struct {
+    const char *cc;         // C compiler command.
+    const char *flags;      // Extra compiler flags (shell words).
+    int level;              // Optimization level (0-3).
+} NativeOptions;
+
+/*
+***************************************************************************
+*                           Routine Prototypes
+***************************************************************************
+*/
+
+/* Initializes an empty compilation context with the given options. A context
+ * holds all state of a compilation, so each thread compiles on its own. */
+void initCompileContext (CompileContext *ctx, const CompileOptions *options);
+
+/* Compiles the source read from `fp` on context `ctx`. All diagnostics are
+ * written to `errfp`. On success, the generated C is left in the IR buffer
+ * of the context (see mpio.h) until its next compilation. The context keeps
+ * its allocations for the next compilation. Returns nonzero on failure. */
+int compileStream (CompileContext *ctx, FILE *fp, FILE *errfp);
+
+/* Compiles the `n` bytes of source at `source` as compileStream does. The
+ * byte after them must be NUL. The source must stay unchanged until the
+ * compilation returns. Returns nonzero on failure. */
+int compileBuffer (CompileContext *ctx, const char *source, size_t n, FILE *errfp);
+
+/* Compiles the source read from file descriptor `in` while it arrives,
+ * writing the generated C to file descriptor `out` statement by statement.
+ * Neither the source nor the C is held in memory in full. As output can't
+ * be taken back, a failed compilation ends it in an #error directive.
+ * All diagnostics are written to `errfp`. Returns nonzero on failure. */
+int compileFd (CompileContext *ctx, int in, int out, FILE *errfp);
+
+/* Compiles the source file `in` into the C file `out`, or into the native
+ * executable `out` if `native` is non-NULL. All diagnostics are written to
+ * `errfp`. Unchanged sources are taken from the cache, if open. In mapped
+ * mode, the file is memory-mapped rather than read.
+ * Returns nonzero on failure. */
+int compileFile (CompileContext *ctx, const char *in, const char *out, const NativeOptions *native, FILE *errfp);
+
+/* Frees all memory held by the compilation context. */
+void freeCompileContext (CompileContext *ctx);
+
+#endif
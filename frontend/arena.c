@@ -0,0 +1,114 @@
+#include "arena.h"
+
+/*
+********************************************************************************
+*                    Symbolic Constants & Global Variables                     *
+********************************************************************************
+*/
+
+#define ARENA_DEFAULT_SIZE      (64 << 10)
+#define MAX(a,b)                ((a) > (b) ? (a) : (b))
+
+/*
+********************************************************************************
+*                            Internal Arena Routines                           *
+********************************************************************************
+*/
+
+/* Pushes a new block of at least `n` bytes. Blocks grow geometrically. */
+static void pushArenaBlock (Arena *arena, size_t n) {
+    ArenaBlock *block;
+    size_t size = MAX(n, (arena->block == NULL ? ARENA_DEFAULT_SIZE : 2 * arena->block->size));
+
+    if ((block = malloc(sizeof(ArenaBlock) + size)) == NULL) {
+        fprintf(stderr, "Error: arena: Couldn't allocate block!\n");
+        exit(EXIT_FAILURE);
+    }
+    block->prev = arena->block;
+    block->size = size;
+    arena->block = block;
+    arena->top = 0;
+    arena->size += size;
+}
+
+/* Returns the offset of `p` in the newest block. Requires `p` to lie in it. */
+static size_t arenaOffset (Arena *arena, const void *p) {
+    return (size_t)((const char *)p - arena->block->data);
+}
+
+/*
+********************************************************************************
+*                                Arena Routines                                *
+********************************************************************************
+*/
+
+/* Returns `n` bytes from the arena, aligned to ARENA_ALIGN */
+void *arenaAlloc (Arena *arena, size_t n) {
+    void *p;
+
+    n = ARENA_ROUND(n);
+    if (arena->block == NULL || arena->block->size - arena->top < n) {
+        pushArenaBlock(arena, n);
+    }
+    p = arena->block->data + arena->top;
+    arena->top += n;
+    arena->used += n;
+    return p;
+}
+
+/* Grows the allocation `p` of `n` bytes to `m` bytes in place. Only possible
+ * if it is the most recent allocation and the block has room. Returns nonzero
+ * on success */
+int arenaExtend (Arena *arena, void *p, size_t n, size_t m) {
+    size_t offset;
+
+    if (!arenaIsTop(arena, p, n)) {
+        return 0;
+    }
+    offset = arenaOffset(arena, p);
+    if (arena->block->size - offset < ARENA_ROUND(m)) {
+        return 0;
+    }
+    arena->used += ARENA_ROUND(m) - ARENA_ROUND(n);
+    arena->top = offset + ARENA_ROUND(m);
+    return 1;
+}
+
+/* Returns nonzero if the allocation `p` of `n` bytes is the most recent one */
+int arenaIsTop (Arena *arena, const void *p, size_t n) {
+    return (arena->block != NULL && p != NULL &&
+        (const char *)p + ARENA_ROUND(n) == arena->block->data + arena->top);
+}
+
+/* Releases the allocation `p` of `n` bytes if it is the most recent one. Other
+ * allocations are kept until the arena is reset */
+void arenaRelease (Arena *arena, void *p, size_t n) {
+    if (arenaIsTop(arena, p, n)) {
+        arena->top = arenaOffset(arena, p);
+        arena->used -= ARENA_ROUND(n);
+    }
+}
+
+/* Empties the arena. Multiple blocks are merged into one of their total size,
+ * so that the next use of equal size fits a single block */
+void arenaReset (Arena *arena) {
+    size_t size = arena->size;
+
+    if (arena->block != NULL && arena->block->prev != NULL) {
+        arenaFree(arena);
+        pushArenaBlock(arena, size);
+    }
+    arena->top = 0;
+    arena->used = 0;
+}
+
+/* Frees all memory of the arena */
+void arenaFree (Arena *arena) {
+    ArenaBlock *block, *prev;
+
+    for (block = arena->block; block != NULL; block = prev) {
+        prev = block->prev;
+        free(block);
+    }
+    *arena = (Arena){.block = NULL, .top = 0, .used = 0, .size = 0};
+}
@@ -0,0 +1,70 @@
+#if !defined(ARENA_H)
+#define ARENA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    ***************************************************************************
+    *                              Bump Arena                                 *
+    * AUTHORS: Charles Randolph, Joe Jones.                                   *
+    * SNUMBERS: s2897318, s2990652.                                           *
+    ***************************************************************************
+*/
+
+/*
+********************************************************************************
+*                              Type Definitions                                *
+********************************************************************************
+*/
+
+// Alignment of all arena allocations. Allocations of `n` bytes take ARENA_ROUND(n).
+#define ARENA_ALIGN             16
+#define ARENA_ROUND(n)          (((n) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+// A block of arena memory. Blocks are chained from the newest to the oldest.
+typedef struct arenaBlock {
+    struct arenaBlock *prev;            // Previous (full) block.
+    size_t size;                        // Bytes of data.
+    _Alignas(ARENA_ALIGN) char data[];
+} ArenaBlock;
+
+// A bump arena. Allocations are carved from the top of the newest block. The
+// most recent allocation may grow in place or be released; all others live
+// until the arena is reset.
+typedef struct {
+    ArenaBlock *block;      // Newest block (NULL if none).
+    size_t top;             // Bytes in use in the newest block.
+    size_t used, size;      // Bytes in use and allocated over all blocks.
+} Arena;
+
+/*
+********************************************************************************
+*                                Arena Routines                                *
+********************************************************************************
+*/
+
+/* Returns `n` bytes from the arena, aligned to ARENA_ALIGN */
+void *arenaAlloc (Arena *arena, size_t n);
+
+/* Grows the allocation `p` of `n` bytes to `m` bytes in place. Only possible
+ * if it is the most recent allocation and the block has room. Returns nonzero
+ * on success */
+int arenaExtend (Arena *arena, void *p, size_t n, size_t m);
+
+/* Returns nonzero if the allocation `p` of `n` bytes is the most recent one */
+int arenaIsTop (Arena *arena, const void *p, size_t n);
+
+/* Releases the allocation `p` of `n` bytes if it is the most recent one. Other
+ * allocations are kept until the arena is reset */
+void arenaRelease (Arena *arena, void *p, size_t n);
+
+/* Empties the arena. Multiple blocks are merged into one of their total size,
+ * so that the next use of equal size fits a single block */
+void arenaReset (Arena *arena);
+
+/* Frees all memory of the arena */
+void arenaFree (Arena *arena);
+
+#endif
@@ -0,0 +1,120 @@
+#include <string.h>
+#include "context.h"
+
+/*
+********************************************************************************
+*                    Symbolic Constants & Global Variables                     *
+********************************************************************************
+*/
+
+#define AST_DEFAULT_SIZE        1024
+
+/*
+********************************************************************************
+*                                 Tree Routines                                *
+********************************************************************************
+*/
+
+/* Empties the node pool for a new compilation, keeping its allocation. The
+ * main program is generated as it is parsed if `incremental` is set */
+void initAst (CompileContext *ctx, int incremental) {
+    Ast *ast = &ctx->ast;
+
+    if (ast->nodes == NULL) {
+        ast->size = AST_DEFAULT_SIZE;
+        if ((ast->nodes = malloc(ast->size * sizeof(AstNode))) == NULL) {
+            fprintf(stderr, "Error: ast: Couldn't allocate node pool!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Node 0 is the empty node.
+    ast->nodes[AST_NONE] = (AstNode){.kind = AST_NONE, .vi = NIL};
+    ast->count = ast->built = ast->peak = 1;
+    ast->root = AST_NONE;
+    ast->incremental = incremental;
+}
+
+/* Returns a new node of kind `kind` with operator `op` and operands `a`, `b`, `c`.
+ * It has no token-type and no constant value */
+unsigned astNode (CompileContext *ctx, unsigned kind, unsigned op, unsigned a, unsigned b, unsigned c) {
+    Ast *ast = &ctx->ast;
+
+    if (ast->count == ast->size) {
+        ast->size *= 2;
+        if ((ast->nodes = realloc(ast->nodes, ast->size * sizeof(AstNode))) == NULL) {
+            fprintf(stderr, "Error: ast: Couldn't resize node pool!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    ast->nodes[ast->count] = (AstNode){.kind = kind, .tt = UNDEFINED, .op = op, .vi = NIL,
+        .a = a, .b = b, .c = c, .next = AST_NONE};
+    ast->built++;
+    if (++ast->count > ast->peak) {
+        ast->peak = ast->count;
+    }
+    return ast->count - 1;
+}
+
+/* Returns a new expression node as astNode does, annotated with the token-type
+ * and constant value the checks gave to the expression-variable `var` */
+unsigned astExpression (CompileContext *ctx, unsigned kind, unsigned op, unsigned a, unsigned b, unsigned c, varType var) {
+    unsigned n = astNode(ctx, kind, op, a, b, c);
+    AST_NODE(ctx, n)->tt = var.tt;
+    AST_NODE(ctx, n)->vi = var.vi;
+    return n;
+}
+
+/* Returns an empty list */
+AstList astList (void) {
+    return (AstList){.head = AST_NONE, .tail = AST_NONE};
+}
+
+/* Appends node `n` to `list`. Returns the list */
+AstList astAppend (CompileContext *ctx, AstList list, unsigned n) {
+    if (list.head == AST_NONE) {
+        list.head = n;
+    } else {
+        AST_NODE(ctx, list.tail)->next = n;
+    }
+    list.tail = n;
+    return list;
+}
+
+/* Chains the expression nodes of `varList` into a list. Returns its first node */
+unsigned astExpressionList (CompileContext *ctx, varListType varList) {
+    AstList list = astList();
+    for (int i = 0; i < varList.length; i++) {
+        list = astAppend(ctx, list, varList.list[i].node);
+    }
+    return list.head;
+}
+
+/* Returns a list of declaration nodes for the variables of `varList` */
+unsigned astDeclarations (CompileContext *ctx, varListType varList) {
+    AstList list = astList();
+    unsigned n;
+
+    for (int i = 0; i < varList.length; i++) {
+        varType var = varList.list[i];
+        if (var.tc == TC_VECTOR) {
+            n = astNode(ctx, AST_VECTOR, UNDEFINED, var.id, var.vl, var.vb);
+        } else {
+            n = astNode(ctx, AST_SCALAR, UNDEFINED, var.id, AST_NONE, AST_NONE);
+        }
+        AST_NODE(ctx, n)->tt = var.tt;
+        list = astAppend(ctx, list, n);
+    }
+    return list.head;
+}
+
+/* Incremental Mode: Drops all nodes. Parts of the tree built so far become invalid */
+void dropAstNodes (CompileContext *ctx) {
+    ctx->ast.count = 1;
+}
+
+/* Frees the node pool */
+void freeAst (CompileContext *ctx) {
+    free(ctx->ast.nodes);
+    memset(&ctx->ast, 0, sizeof(Ast));
+}
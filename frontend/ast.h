@@ -0,0 +1,131 @@
+#if !defined(AST_H)
+#define AST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mptypes.h"
+
+/*
+    ***************************************************************************
+    *                          Abstract Syntax Tree                           *
+    * AUTHORS: Charles Randolph, Joe Jones.                                   *
+    * SNUMBERS: s2897318, s2990652.                                           *
+    ***************************************************************************
+*/
+
+/*
+ * The parser builds the program as a tree of nodes while it checks it. Each
+ * node is annotated with the result of the checks (its token-type, and the
+ * value-index of its value if the checks folded it to a constant). The code
+ * generator then walks the tree (see irgen.h).
+ *
+ * Nodes live in a single pool and refer to each other by index, never by
+ * pointer, so the pool may grow and the tree may be copied or stored as is.
+ * Index 0 is the empty node AST_NONE, which also ends every list. Lists of
+ * statements or arguments are chained through `next`.
+ *
+ * In incremental mode (stream mode, see compile.c), the main program is
+ * generated declaration by declaration and statement by statement as they are
+ * parsed. Their nodes are dropped once generated, so the tree never holds
+ * more than the statement being parsed.
+ */
+
+/*
+********************************************************************************
+*                               Type Definitions                               *
+********************************************************************************
+*/
+
+// Node kinds. Operands `a`, `b` and `c` of each kind are given alongside.
+typedef enum {
+    AST_NONE,               // Empty node.
+
+    // Expressions.
+    AST_CONST,              // Constant: Value at value-index `vi`.
+    AST_ID,                 // Variable: a = identifier.
+    AST_INDEX,              // Vector element: a = identifier, b = index, c = lower bound.
+    AST_UNARY,              // Signed expression: op = sign, a = operand.
+    AST_BINARY,             // Arithmetic: op = operator, a, b = operands.
+    AST_COMPARE,            // Comparison: op = relational operator, a, b = operands.
+    AST_CALL,               // Routine call: a = identifier, b = arguments.
+
+    // Statements.
+    AST_ASSIGN,             // Assignment: a = variable (AST_ID | AST_INDEX), b = expression.
+    AST_IF,                 // Conditional: a = guard, b = then, c = else.
+    AST_WHILE,              // Loop: a = guard, b = body.
+    AST_BLOCK,              // Compound statement: a = statements.
+    AST_READLN,             // Input: a = arguments.
+    AST_WRITELN,            // Output: a = arguments.
+
+    // Declarations.
+    AST_SCALAR,             // Scalar declaration: a = identifier.
+    AST_VECTOR,             // Vector declaration: a = identifier, b = length, c = lower bound.
+    AST_ROUTINE,            // Routine: a = identifier, b = nested routines, c = body.
+    AST_PROGRAM             // Program: a = declarations, b = routines, c = body.
+} AstKind;
+
+// A node of the tree.
+typedef struct {
+    unsigned char kind;     // Node kind (AST_<kind>).
+    unsigned char tt;       // Token-type of the value, or of a declaration.
+    unsigned short op;      // Operator (MP_<token>), if any.
+    unsigned vi;            // Value-Index of the folded constant value, or NIL.
+    unsigned a, b, c;       // Operands (see AstKind).
+    unsigned next;          // Next node of the list holding this one.
+} AstNode;
+
+// A list of nodes under construction.
+typedef struct {
+    unsigned head, tail;    // First and last node (AST_NONE if empty).
+} AstList;
+
+// Node pool of a compilation.
+typedef struct {
+    AstNode *nodes;         // Nodes, by index.
+    unsigned count, size;   // Nodes in use, and allocated.
+    unsigned built;         // Nodes built over the compilation, dropped ones included.
+    unsigned peak;          // Most nodes in use at once.
+    unsigned root;          // Program node, once parsed (AST_NONE until then).
+    int incremental;        // Set if the main program is generated as it is parsed.
+} Ast;
+
+// Returns the node at index `n` of compilation `ctx`. Valid until the next node is built.
+#define AST_NODE(ctx, n)    (&(ctx)->ast.nodes[(n)])
+
+/*
+********************************************************************************
+*                                 Tree Routines                                *
+********************************************************************************
+*/
+
+/* Empties the node pool for a new compilation, keeping its allocation. The
+ * main program is generated as it is parsed if `incremental` is set */
+void initAst (CompileContext *ctx, int incremental);
+
+/* Returns a new node of kind `kind` with operator `op` and operands `a`, `b`, `c`.
+ * It has no token-type and no constant value */
+unsigned astNode (CompileContext *ctx, unsigned kind, unsigned op, unsigned a, unsigned b, unsigned c);
+
+/* Returns a new expression node as astNode does, annotated with the token-type
+ * and constant value the checks gave to the expression-variable `var` */
+unsigned astExpression (CompileContext *ctx, unsigned kind, unsigned op, unsigned a, unsigned b, unsigned c, varType var);
+
+/* Returns an empty list */
+AstList astList (void);
+
+/* Appends node `n` to `list`. Returns the list */
+AstList astAppend (CompileContext *ctx, AstList list, unsigned n);
+
+/* Chains the expression nodes of `varList` into a list. Returns its first node */
+unsigned astExpressionList (CompileContext *ctx, varListType varList);
+
+/* Returns a list of declaration nodes for the variables of `varList` */
+unsigned astDeclarations (CompileContext *ctx, varListType varList);
+
+/* Incremental Mode: Drops all nodes. Parts of the tree built so far become invalid */
+void dropAstNodes (CompileContext *ctx);
+
+/* Frees the node pool */
+void freeAst (CompileContext *ctx);
+
+#endif
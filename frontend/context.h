@@ -0,0 +1,58 @@
+#if !defined(CONTEXT_H)
+#define CONTEXT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "debug.h"
+#include "strtab.h"
+#include "numtab.h"
+#include "symtab.h"
+#include "arena.h"
+#include "ast.h"
+#include "stats.h"
+#include "mpio.h"
+#include "ir.h"
+
+/*
+***************************************************************************
+*                           Compilation Context                           *
+* AUTHORS: Charles Randolph, Joe Jones.                                   *
+* SNUMBERS: s2897318, s2990652.                                           *
+***************************************************************************
+*/
+
+/*
+***************************************************************************
+*                            Type Definitions
+***************************************************************************
+*/
+
+/* Options of a compilation */
+typedef struct {
+    int debug;              // Debug Mode: Parsed file is written to the diagnostic stream.
+    int quiet;              // Quiet Mode: Warnings are disabled.
+    int color;              // Color Mode: Output is color-formatted.
+    int stats;              // Statistics Mode: STATS_TEXT or STATS_JSON if timed (see stats.h).
+    int mapped;             // Mapped Mode: Source files are memory-mapped.
+    int level;              // Optimization level of the generated code (see passes.h).
+} CompileOptions;
+
+/* All state of a compilation. Every routine of the compiler works on the
+ * context it is given, so compilations on different contexts may run
+ * concurrently. A context may be reused, keeping its allocations. */
+struct compileContext {
+    CompileOptions options;     // Options of the compilation.
+    DebugState debug;           // Diagnostic stream, error flag and line buffer.
+    StringTable strtab;         // Identifier lexemes.
+    NumberTable numtab;         // Constant values.
+    SymbolTable symtab;         // Identifiers in scope.
+    Arena lists;                // Lists of parser values (see mptypes.h).
+    Ast ast;                    // Syntax tree of the program (see ast.h).
+    IRCode code;                // Three-address code being generated (see ir.h).
+    IRBuffer ir;                // Generated C.
+    unsigned t, l;              // T-Label and L-Label counters (see irgen.h).
+    CompileStats stats;         // Statistics of the last compilation.
+    PhaseClock clock;           // Current phase and the time it was entered.
+};
+
+#endif
@@ -1,275 +1,437 @@
-#include "debug.h"
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "context.h"
 
 /*
 ***************************************************************************
-*                Private Type Definitions & Global Variables
+*                     Symbolic Constants & Private Macros
 ***************************************************************************
 */
 
-#define MAX_LINE_DEBUG  1000
-
-// No-Warnings Flag.
-int noWarnings;
-
-// Line buffer for symantic debug purposes.
-char lineBuffer[MAX_LINE_DEBUG];
-
-// Line buffer lead pointer.
-int lp;
+#define SOURCE_BLOCK_SIZE       4096
+#define SOURCE_DEFAULT_LINES    256
+#define MIN(a,b)                ((a) < (b) ? (a) : (b))
+#define MAX(a,b)                ((a) > (b) ? (a) : (b))
 
 /*
 ***************************************************************************
-*                     Private Syntactic Debug Routines
+*                       Private Source Text Routines
 ***************************************************************************
 */
 
-// Print routine for structural syntax.
-static void printStructure () {
-    const char *s = (inColor ? C_TAF(BOL, BLK, "%s") : "%s");
-    lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, s, yytext);
+// Appends the line starting at `offset` to the line index.
+static void pushLine (SourceText *st, size_t offset) {
+    if (st->count == st->size) {
+        st->size = (st->size == 0 ? SOURCE_DEFAULT_LINES : st->size * 2);
+        if ((st->lines = realloc(st->lines, st->size * sizeof(size_t))) == NULL) {
+            fprintf(stderr, "Error: pushLine: Couldn't resize line index!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    st->lines[st->count++] = offset;
 }
 
-// Print routine for control characters.
-static void printControl() {
-    const char *s = (inColor ? C_TAF(BOL, BLK, "%s") : "%s");
-    lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, s, yytext);
+// Empties the source text. Its allocations are kept.
+static void resetSource (SourceText *st) {
+    st->text = NULL;
+    st->base = st->length = 0;
+    st->fd = -1;
+    st->start = 0;
+    st->retain = 0;
+    st->count = 0;
+    st->indexed = 0;
+    pushLine(st, 0);
 }
 
-// Print routine for identifiers.
-static void printIdentifier () {
-    const char *s = (inColor ? C_TAF(BOL, BLU, "%s") : "%s");
-    lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, s, yytext);
+// Indexes the lines of the source starting before `offset`.
+static void indexLines (SourceText *st, size_t offset) {
+    char block[SOURCE_BLOCK_SIZE];
+    const char *p, *q, *end;
+    ssize_t n;
+
+    // Text in memory: Ends at the text read so far.
+    if (st->text != NULL) {
+        offset = MIN(offset, st->base + st->length);
+        for (p = st->text + (st->indexed - st->base), end = st->text + (offset - st->base);
+            p < end && (q = memchr(p, '\n', end - p)) != NULL; p = q + 1) {
+            pushLine(st, st->base + (q + 1 - st->text));
+        }
+        st->indexed = MAX(st->indexed, offset);
+        return;
+    }
+
+    // Text in a file: Read in blocks, up to the end of file.
+    while (st->fd >= 0 && st->indexed < offset) {
+        n = pread(st->fd, block, MIN(sizeof(block), offset - st->indexed), st->start + st->indexed);
+        if (n <= 0) {
+            break;
+        }
+        for (p = block, end = block + n; (q = memchr(p, '\n', end - p)) != NULL; p = q + 1) {
+            pushLine(st, st->indexed + (q + 1 - block));
+        }
+        st->indexed += n;
+    }
 }
 
-// Print routine for literals.
-static void printLiteral () {
-    const char *s = (inColor ? C_TAF(DIM, CYN, "%s") : "%s");
-    lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, s, yytext);
+// Returns the index of the line holding `offset` (its start if at the end of a line).
+static unsigned lineOf (SourceText *st, size_t offset) {
+    unsigned lo = 0, hi, mid;
+
+    indexLines(st, offset);
+    for (hi = st->count; hi - lo > 1; ) {
+        mid = lo + (hi - lo) / 2;
+        if (st->lines[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
 }
 
-// Print routine for operators.
-static void printOperation () {
-    const char *s = (inColor ? C_TAF(BOL, MAG, "%s") : "%s");
-    lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, s, yytext);
+// Prints the `n` characters of source at `text`, showing tabs as arrows.
+static void printText (CompileContext *ctx, const char *text, size_t n) {
+    FILE *fp = ctx->debug.errfp;
+    const char *p, *end = text + n;
+
+    for (; text < end; text = p + 1) {
+        if ((p = memchr(text, '\t', end - text)) == NULL) {
+            fwrite(text, 1, end - text, fp);
+            return;
+        }
+        fwrite(text, 1, p - text, fp);
+        fputs((ctx->options.color ? C_TAF(DIM, BLK, "--->") : "--->"), fp);
+    }
 }
 
-// Print routine for whitespace.
-static void printWhitespace () {
-    const char *s;
-    switch (*yytext) {
-        case '\n':
-            s = (inColor ? ("%s" C_TAF(DIM, BLK, "\\n") "\n") : "%s\\n\n");
-            if (inDebug) { fprintf(stderr, s, lineBuffer); } 
-
-            s = (inColor ? C_TAF(DIM, BLK, "%d.\t") : "%d.\t");
-            lp = 0;
-            lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, s, yylineno + 1);
-            break;
-        case '\t':
-            s = (inColor ? C_TAF(DIM, BLK, "--->") : "--->");
-            lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, s);
-            break;
-        default:
-            lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, " ");
-            break;
+// Prints the source between offsets `from` and `to`. Text no longer held
+// (or past the end of the source) is left out.
+static void printSource (CompileContext *ctx, size_t from, size_t to) {
+    SourceText *st = &ctx->debug.source;
+    char block[SOURCE_BLOCK_SIZE];
+    ssize_t n;
+
+    if (st->text != NULL) {
+        from = MAX(from, st->base);
+        to = MIN(to, st->base + st->length);
+        if (from < to) {
+            printText(ctx, st->text + (from - st->base), to - from);
+        }
+        return;
+    }
+    for (; st->fd >= 0 && from < to; from += n) {
+        if ((n = pread(st->fd, block, MIN(sizeof(block), to - from), st->start + from)) <= 0) {
+            return;
+        }
+        printText(ctx, block, n);
     }
 }
 
-// Print routine for misplaced tokens.
-static void printNaughty() {
-    if (inColor) {
-        fprintf(stderr, C_TAF(BOL, RED, "\nBAD TOKEN: "));
-        fprintf(stderr, C_TAF(UND, MAG, "%s"), yytext);
-    } else {
-        fprintf(stderr, "\nBAD TOKEN: ");
-        fprintf(stderr, "%s", yytext);
+// Prints line `line`, from offset `from` up to `to`, as in Debug Mode.
+static void printLine (CompileContext *ctx, int line, size_t from, size_t to) {
+    fprintf(ctx->debug.errfp, (ctx->options.color ? C_TAF(DIM, BLK, "%d.\t") : "%d.\t"), line);
+    printSource(ctx, from, to);
+}
+
+// Appends a chunk of an unseekable stream to the retained text, first dropping
+// the lines before that of the last token (or of the next line to echo).
+static void retainChunk (CompileContext *ctx, const char *chunk, size_t n) {
+    DebugState *d = &ctx->debug;
+    SourceText *st = &d->source;
+    size_t keep = (ctx->options.debug ? MIN(d->offset, d->echoed) : d->offset);
+    unsigned k = lineOf(st, keep);
+
+    keep = st->lines[k];
+    memmove(st->lines, st->lines + k, (st->count - k) * sizeof(size_t));
+    st->count -= k;
+    memmove(st->tail, st->tail + (keep - st->base), st->base + st->length - keep);
+    st->length -= keep - st->base;
+    st->base = keep;
+
+    if (st->length + n > st->tailSize) {
+        st->tailSize = MAX(st->tailSize * 2, st->length + n);
+        if ((st->tail = realloc(st->tail, st->tailSize)) == NULL) {
+            fprintf(stderr, "Error: retainChunk: Couldn't resize source text!\n");
+            exit(EXIT_FAILURE);
+        }
     }
-    putc('\n', stderr);
+    memcpy(st->tail + st->length, chunk, n);
+    st->length += n;
+    st->text = st->tail;
 }
 
 /*
 ***************************************************************************
-*                          Syntactic Debug Routines
+*                     Private Semantic Debug Routines
 ***************************************************************************
 */
 
-void printToken (SyntaxType t) {
-    static int init = 0;
+// Prints message `msg` with its arguments. Accepts: Strings (%s), Integers (%d),
+// and floats (%f).
+static void formatMessage (FILE *fp, const char *msg, va_list ap) {
+    const char *p, *sval;
 
-    if (!init) {
-        if (inColor) {
-            lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, C_TAF(DIM, BLK, "%d.\t"), yylineno);
-        } else {
-            lp += snprintf(lineBuffer + lp, MAX_LINE_DEBUG - lp, "%d.\t", yylineno);
+    for (p = msg; *p != '\0'; p++) {
+
+        if (*p != '%') {
+            putc(*p, fp);
+            continue;
+        }
+
+        switch (*(++p)) {
+            case 'd':
+                fprintf(fp, "%d", va_arg(ap, int));
+                break;
+            case 'f':
+                fprintf(fp, "%.3f", va_arg(ap, double));
+                break;
+            case 's':
+                for (sval = va_arg(ap, char *); *sval != '\0'; sval++) {
+                    putc(*sval, fp);
+                }
+                break;
+            default:
+                putc(*p, fp);
+                break;
         }
-        init = 1;
     }
+}
+
+// Passes an error or warning message, uncolored, to the diagnostic sink of
+// the compilation, if any.
+static void sinkMessage (CompileContext *ctx, int isError, const char *msg, va_list ap) {
+    DebugState *d = &ctx->debug;
+    char *text = NULL;
+    size_t size = 0;
+    FILE *fp;
 
-    switch (t) {
-        case Structure: printStructure();
-        break;
+    if (d->sink == NULL) {
+        return;
+    }
+    if ((fp = open_memstream(&text, &size)) == NULL) {
+        fprintf(stderr, "Error: sinkMessage: Couldn't allocate message buffer!\n");
+        exit(EXIT_FAILURE);
+    }
+    formatMessage(fp, msg, ap);
+    fclose(fp);
+    d->sink(d->sinkArg, isError, d->line, text);
+    free(text);
+}
 
-        case Control:  printControl();
-        break;
+// Prints the line of the last token, up to its end, rebuilt from the source.
+static void printOffendingLine (CompileContext *ctx) {
+    DebugState *d = &ctx->debug;
+    unsigned k = lineOf(&d->source, d->offset);
 
-        case Literal: printLiteral();
-        break;
+    fputs((ctx->options.color ? "\n" C_TAF(BOL, RED, "--> ") : "\n--> "), d->errfp);
+    printLine(ctx, d->line, d->source.lines[k], d->offset);
+    putc('\n', d->errfp);
+}
 
-        case Identifier: printIdentifier();
-        break;
-        
-        case Operation: printOperation();
-        break;
+/*
+***************************************************************************
+*                            Debug State Routines
+***************************************************************************
+*/
 
-        case Whitespace: printWhitespace();
-        break;
+/* Resets the diagnostic state and error flag for a new compilation. All
+ * diagnostics of the compilation are written to `fp`. */
+void initDebug (CompileContext *ctx, FILE *fp) {
+    DebugState *d = &ctx->debug;
+    d->errfp = fp;
+    d->isError = 0;
+    d->line = d->echoLine = 1;
+    d->offset = d->echoed = 0;
+    resetSource(&d->source);
+}
 
-        case Naughty: printNaughty();
-        break;
+/* Sets the source of the compilation to the `n` bytes at `text`, which must
+ * stay unchanged until the compilation returns. */
+void setSourceText (CompileContext *ctx, const char *text, size_t n) {
+    SourceText *st = &ctx->debug.source;
+    resetSource(st);
+    st->text = text;
+    st->length = n;
+}
 
-        case EndOfFile: if (inDebug) { fprintf(stderr, "%s\n", lineBuffer); };
+/* Sets the source of the compilation to the stream `fp`, read from its
+ * current position with readSourceChunk. Regular files are read again when
+ * a line is needed. Text from other streams is retained as it is read. */
+void setSourceStream (CompileContext *ctx, FILE *fp) {
+    SourceText *st = &ctx->debug.source;
+    int fd = fileno(fp);
+    struct stat sb;
+    off_t start;
+
+    resetSource(st);
+    if (fd >= 0 && fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode) &&
+        (start = lseek(fd, 0, SEEK_CUR)) >= 0) {
+        st->fd = fd;
+        st->start = start;
+    } else {
+        st->retain = 1;
     }
 }
 
+/* Reads up to `max` bytes of source from `in` into `buf`. Streams backed by
+ * a file descriptor are read with a single read(2), so the chunks of a pipe
+ * are scanned as soon as they arrive. Returns zero at end of input or on error */
+size_t readSourceChunk (CompileContext *ctx, FILE *in, char *buf, size_t max) {
+    ssize_t n;
+    int fd = fileno(in);
+
+    if (fd < 0) {
+        n = fread(buf, 1, max, in);
+    } else {
+        while ((n = read(fd, buf, max)) < 0 && errno == EINTR) {
+            continue;
+        }
+    }
+    if (n <= 0) {
+        return 0;
+    }
+    if (ctx->debug.source.retain) {
+        retainChunk(ctx, buf, n);
+    }
+    return n;
+}
+
+/* Frees the source text state of the compilation. */
+void freeDebug (CompileContext *ctx) {
+    SourceText *st = &ctx->debug.source;
+    free(st->lines);
+    free(st->tail);
+    memset(st, 0, sizeof(SourceText));
+}
+
+/*
+***************************************************************************
+*                          Syntactic Debug Routines
+***************************************************************************
+*/
+
+/* Debug Mode: Echoes all source lines which end before `offset`, or all
+ * remaining source if `last` is set. Does nothing unless in debug mode */
+void echoSource (CompileContext *ctx, size_t offset, int last) {
+    DebugState *d = &ctx->debug;
+    SourceText *st = &d->source;
+    unsigned k;
+
+    if (!ctx->options.debug) {
+        return;
+    }
+    indexLines(st, offset);
+    while ((k = lineOf(st, d->echoed) + 1) < st->count && st->lines[k] <= offset) {
+        printLine(ctx, d->echoLine++, d->echoed, st->lines[k] - 1);
+        fputs((ctx->options.color ? C_TAF(DIM, BLK, "\\n") "\n" : "\\n\n"), d->errfp);
+        d->echoed = st->lines[k];
+    }
+    if (last) {
+        printLine(ctx, d->echoLine, d->echoed, offset);
+        putc('\n', d->errfp);
+        d->echoed = offset;
+    }
+}
+
+/* Prints the unexpected token lexeme of `length` characters. The lexeme
+ * needn't be terminated */
+void printBadToken (CompileContext *ctx, const char *text, int length) {
+    DebugState *d = &ctx->debug;
+    if (ctx->options.color) {
+        fprintf(d->errfp, C_TAF(BOL, RED, "\nBAD TOKEN: "));
+        fprintf(d->errfp, C_TAF(UND, MAG, "%.*s"), length, text);
+    } else {
+        fprintf(d->errfp, "\nBAD TOKEN: ");
+        fprintf(d->errfp, "%.*s", length, text);
+    }
+    putc('\n', d->errfp);
+}
+
 /*
 ***************************************************************************
 *                          Semantic Debug Routines
 ***************************************************************************
 */
 
-/* Prints a warning to stderr with description `msg`.
+/* Prints a warning to the diagnostic stream with description `msg`.
  * Accepts: Strings (%s), Integers (%d), and floats (%f) as arguments */
-void printWarning (char *msg, ...) {
-    char *p, *sval;
-    int ival;
-    double fval;
+void printWarning (CompileContext *ctx, char *msg, ...) {
+    DebugState *d = &ctx->debug;
+    va_list ap;
 
     // If in quiet mode: Do not print the warning.
-    if (inQuiet) { 
+    if (ctx->options.quiet) { 
         return;
     }
 
-    // Initialize the variadic argument list.
-    va_list ap;
+    // Pass the message to the sink, if any.
     va_start(ap, msg);
+    sinkMessage(ctx, 0, msg, ap);
+    va_end(ap);
 
     // Prints warning message header.
-    if (inColor) {
-        fprintf(stderr, "\n" C_TAF(BOL, YEL, "Warning") " :: ");
+    if (ctx->options.color) {
+        fprintf(d->errfp, "\n" C_TAF(BOL, YEL, "Warning") " :: ");
     } else {
-        fprintf(stderr, "\nWarning :: ");
+        fprintf(d->errfp, "\nWarning :: ");
     }
 
     // Print formatted message: Set formatting.
-    if (inColor) {
-        fprintf(stderr, CONFIG_AF(UND, YEL));
+    if (ctx->options.color) {
+        fprintf(d->errfp, CONFIG_AF(UND, YEL));
     }
 
     // Print formatted message.
-    for (p = msg; *p != '\0'; p++) {
-
-        if (*p != '%') {
-            putc(*p, stderr);
-            continue;
-        }
-
-        switch (*(++p)) {
-            case 'd':
-                ival = va_arg(ap, int);
-                fprintf(stderr, "%d", ival);
-                break;
-            case 'f':
-                fval = va_arg(ap, double);
-                fprintf(stderr, "%.3f", fval);
-                break;
-            case 's':
-                for (sval = va_arg(ap, char *); *sval != '\0'; sval++) {
-                    putc(*sval, stderr);
-                }
-                break;
-            default:
-                putchar(*p);
-                break;
-        }
-    }
+    va_start(ap, msg);
+    formatMessage(d->errfp, msg, ap);
     va_end(ap);
 
     // End formatting.
-    if (inColor) {
-        fprintf(stderr, RESET);
+    if (ctx->options.color) {
+        fprintf(d->errfp, RESET);
     }
 
     // Print line.
-    if (inColor) {
-        fprintf(stderr, "\n" C_TAF(BOL, RED, "--> ") "%s\n", lineBuffer);
-    } else {
-        fprintf(stderr, "\n--> %s\n", lineBuffer);
-    }
+    printOffendingLine(ctx);
 }
 
-/* Prints a error to stderr with description `msg`.
+/* Prints a error to the diagnostic stream with description `msg`.
  * Accepts: Strings (%s), Integers (%d), and floats (%f) as arguments */
-void printError (char *msg, ...) {
-    char *p, *sval;
-    int ival;
-    double fval;
+void printError (CompileContext *ctx, char *msg, ...) {
+    DebugState *d = &ctx->debug;
+    va_list ap;
 
     // Set the error flag to true */
-    isError = 1;
+    d->isError = 1;
 
-    // Initialize the variadic argument list.
-    va_list ap;
+    // Pass the message to the sink, if any.
     va_start(ap, msg);
+    sinkMessage(ctx, 1, msg, ap);
+    va_end(ap);
 
     // Prints warning message header.
-    if (inColor) {
-        fprintf(stderr, "\n" C_TAF(BOL, RED, "Error") " :: ");
+    if (ctx->options.color) {
+        fprintf(d->errfp, "\n" C_TAF(BOL, RED, "Error") " :: ");
     } else {
-        fprintf(stderr, "\nError :: ");
+        fprintf(d->errfp, "\nError :: ");
     }
 
     // Print formatted message: Set formatting.
-    if (inColor) {
-        fprintf(stderr, CONFIG_AF(UND, RED));
+    if (ctx->options.color) {
+        fprintf(d->errfp, CONFIG_AF(UND, RED));
     }
 
-    for (p = msg; *p != '\0'; p++) {
-
-        if (*p != '%') {
-            putc(*p, stderr);
-            continue;
-        }
-
-        switch (*(++p)) {
-            case 'd':
-                ival = va_arg(ap, int);
-                fprintf(stderr, "%d", ival);
-                break;
-            case 'f':
-                fval = va_arg(ap, double);
-                fprintf(stderr, "%.3f", fval);
-                break;
-            case 's':
-                for (sval = va_arg(ap, char *); *sval != '\0'; sval++) {
-                    putc(*sval, stderr);
-                }
-                break;
-            default:
-                putchar(*p);
-                break;
-        }
-    }
+    // Print formatted message.
+    va_start(ap, msg);
+    formatMessage(d->errfp, msg, ap);
     va_end(ap);
 
     // End formatting.
-    if (inColor) {
-        fprintf(stderr, RESET);
+    if (ctx->options.color) {
+        fprintf(d->errfp, RESET);
     }
 
     // Print line.
-    if (inColor) {
-        fprintf(stderr, "\n" C_TAF(BOL, RED, "--> ") "%s\n", lineBuffer);
-    } else {
-        fprintf(stderr, "\n--> %s\n", lineBuffer);
-    }
+    printOffendingLine(ctx);
 }
@@ -21,31 +21,69 @@
 ***************************************************************************
 */
 
-// Debug Mode Flag: If set, parsed file is written to stderr.
-int inDebug;
+// The context of a compilation (see context.h).
+typedef struct compileContext CompileContext;
 
-// Quiet Mode Flag: If set, warnings are disabled.
-int inQuiet;
+// Receiver of the errors and warnings of a compilation, besides the diagnostic
+// stream. Called with the message (uncolored) and the line it was raised on.
+typedef void (*DiagnosticSink) (void *arg, int isError, int line, const char *msg);
 
-// Color Mode Flag: If set, output is color-formatted.
-int inColor;
+// Source text of a compilation. Nothing is recorded while scanning: Lines are
+// rebuilt from the source when a diagnostic needs them, through an index of
+// line offsets which is only built as far as needed. The source is read in
+// place if held in memory, or from its descriptor if seekable. Otherwise the
+// chunks read are retained from the start of the current line on.
+typedef struct {
+    const char *text;           // Source text from `base` on (NULL if read from `fd`).
+    size_t base, length;        // Offset of `text` in the source, and its length.
+    char *tail;                 // Retained text of an unseekable stream.
+    size_t tailSize;            // Allocated size of the retained text.
+    int fd;                     // Seekable source descriptor (-1 if none).
+    long start;                 // Position of the source in `fd`.
+    int retain;                 // Set if the text read is retained in `tail`.
+    size_t *lines;              // Line index: Offsets of the line starts from `base` on.
+    unsigned count, size;       // Lines indexed, and allocated.
+    size_t indexed;             // Offset up to which lines are indexed.
+} SourceText;
 
-// Error Flag: If set, then an error was encountered.
-int isError;
+// Diagnostic state of a compilation.
+typedef struct {
+    FILE *errfp;                        // Diagnostic output stream.
+    DiagnosticSink sink;                // Diagnostic receiver (NULL if none).
+    void *sinkArg;                      // Argument passed to the sink.
+    int line;                           // Line of the last token.
+    size_t offset;                      // Offset of the end of the last token.
+    int isError;                        // Set if an error was encountered.
+    SourceText source;                  // Source text, for rebuilding lines.
+    size_t echoed;                      // Debug Mode: Source echoed so far.
+    int echoLine;                       // Debug Mode: Next line to echo.
+} DebugState;
 
-typedef enum {
-    Structure,
-    Control,
-    Identifier,
-    Literal,
-    Operation,
-    Whitespace,
-    Naughty,
-    EndOfFile
-} SyntaxType;
+/*
+***************************************************************************
+*                      Debug State Routine Prototypes
+***************************************************************************
+*/
+
+/* Resets the diagnostic state and error flag for a new compilation. All
+ * diagnostics of the compilation are written to `fp`. */
+void initDebug (CompileContext *ctx, FILE *fp);
 
-extern char *yytext;
-extern int yylineno;
+/* Sets the source of the compilation to the `n` bytes at `text`, which must
+ * stay unchanged until the compilation returns. */
+void setSourceText (CompileContext *ctx, const char *text, size_t n);
+
+/* Sets the source of the compilation to the stream `fp`, read from its
+ * current position with readSourceChunk. */
+void setSourceStream (CompileContext *ctx, FILE *fp);
+
+/* Reads up to `max` bytes of source from `in` into `buf`. Streams backed by
+ * a file descriptor are read with a single read(2), so the chunks of a pipe
+ * are scanned as soon as they arrive. Returns zero at end of input or on error */
+size_t readSourceChunk (CompileContext *ctx, FILE *in, char *buf, size_t max);
+
+/* Frees the source text state of the compilation. */
+void freeDebug (CompileContext *ctx);
 
 /*
 ***************************************************************************
@@ -53,9 +91,13 @@ extern int yylineno;
 ***************************************************************************
 */
 
-/* Prints the current token stored in yytext. Color codes according to
-    abstract category */
-void printToken (SyntaxType t);
+/* Debug Mode: Echoes all source lines which end before `offset`, or all
+ * remaining source if `last` is set. Does nothing unless in debug mode */
+void echoSource (CompileContext *ctx, size_t offset, int last);
+
+/* Prints the unexpected token lexeme of `length` characters. The lexeme
+ * needn't be terminated */
+void printBadToken (CompileContext *ctx, const char *text, int length);
 
 /*
 ***************************************************************************
@@ -63,12 +105,12 @@ void printToken (SyntaxType t);
 ***************************************************************************
 */
 
-/* Prints a warning to stderr with description `msg`.
+/* Prints a warning to the diagnostic stream with description `msg`.
  * Accepts: Strings (%s), Integers (%d), and floats (%f) as arguments */
-void printWarning (char *msg, ...);
+void printWarning (CompileContext *ctx, char *msg, ...);
 
-/* Prints a error to stderr with description `msg`.
+/* Prints a error to the diagnostic stream with description `msg`.
  * Accepts: Strings (%s), Integers (%d), and floats (%f) as arguments */
-void printError (char *msg, ...);
+void printError (CompileContext *ctx, char *msg, ...);
 
 #endif
\ No newline at end of file
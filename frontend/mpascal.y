@@ -16,26 +16,59 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* Custom Routine Imports */
+#include "irgen.h"      // Intermediate-Code Generator.
 
+/* Routines local to lex.yy.c */
+extern int yylex();
+extern int yyget_lineno(yyscan_t scanner);
+extern char *yyget_text(yyscan_t scanner);
+extern int yyget_leng(yyscan_t scanner);
+
+/* Handler for Bison parse errors. Parsing is aborted after returning */
+int yyerror(yyscan_t scanner, CompileContext *ctx, char *s) {
+  printError(ctx, "PARSE ERROR (%d)", yyget_lineno(scanner));
+  return 0;
+}
 
-/* Variables local to debug. */
-extern int inDebug;
-extern int inQuiet;
-extern int inColor;
-extern int isError;
+/* Returns the value of the real literal just scanned. Its lexeme may be a
+   span of the source (see scanner.h), so a terminated copy is converted */
+static double realLexeme (yyscan_t scanner) {
+  int n = yyget_leng(scanner);
+  char digits[64], *copy = (n < (int)sizeof(digits) ? digits : malloc(n + 1));
+  double value;
 
-/* Variables local to lex.yy.c */
-extern int yylex();
-extern void yylex_destroy();
-extern int yylineno;
-extern char *yytext;
-
-/* Handler for Bison parse errors */
-int yyerror(char *s) {
-  printf("PARSE ERROR (%d)\n", yylineno);
-  exit(EXIT_SUCCESS);
+  if (copy == NULL) {
+    fprintf(stderr, "Error: realLexeme: Couldn't copy lexeme!\n");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(copy, yyget_text(scanner), n);
+  copy[n] = '\0';
+  value = atof(copy);
+  if (copy != digits) {
+    free(copy);
+  }
+  return value;
+}
+
+/* Code is only generated for the main program, and only while it is error free */
+#define GENERATE   (ctx->debug.isError == 0 && currentTableScope(ctx) == 0)
+
+/* Statements of actions, timed as semantic analysis or IR generation (see stats.h) */
+#define SEMANTIC(...)   IN_PHASE(ctx, PHASE_SEMANTICS, __VA_ARGS__)
+#define EMIT(...)       if (GENERATE) IN_PHASE(ctx, PHASE_IRGEN, __VA_ARGS__)
+
+/* Appends statement `stmt` to the main program `body`. Returns the body. In
+   incremental mode the statement is generated right away and dropped (see ast.h) */
+static AstList mainStatement (CompileContext *ctx, AstList body, unsigned stmt) {
+  if (ctx->ast.incremental) {
+    EMIT(genStatement(ctx, stmt); flushCode(ctx));
+    dropAstNodes(ctx);
+    return body;
+  }
+  return astAppend(ctx, body, stmt);
 }
 
 %}
@@ -115,14 +148,31 @@ int yyerror(char *s) {
 ********************************************************************************
 */
 
+// Reentrant Parser: All parser state is local to a call of yyparse, all
+// compiler state to the context it is given.
+%define api.pure full
+
+// Push Parser: Besides yyparse, tokens may be pushed one at a time with
+// yypush_parse, letting the caller act between statements (see compile.c).
+%define api.push-pull both
+%parse-param {yyscan_t scanner} {CompileContext *ctx}
+%lex-param {yyscan_t scanner}
+
 // YYSTYPE Dependencies.
 %code requires {
+  #if !defined(YY_TYPEDEF_YY_SCANNER_T)
+  #define YY_TYPEDEF_YY_SCANNER_T
+  typedef void *yyscan_t;         // Reentrant scanner handle (see lex.yy.c).
+  #endif
+  #include "context.h"    // Compilation Context.
+  #include "ast.h"        // Syntax Tree.
   #include "debug.h"
   #include "mptypes.h"    // Types used in symantic checker.
   #include "strtab.h"     // String Table.
   #include "numtab.h"     // Number Table.
   #include "symtab.h"     // Symbol Table.
   #include "semantics.h"
+  #include "stats.h"      // Phase timing.
 }
 
 // Bison YYSTYPE Declarations.
@@ -131,10 +181,12 @@ int yyerror(char *s) {
   descType      desc;
   varType       var;
   varListType   varList;
+  AstList       list;
 }
 
 // Nonterminal return type rules.
-%type <num> standardType identifier statementList optionalStatements sign
+%type <num> standardType identifier sign relop statement procedureStatement compoundStatement subprogramDeclaration
+%type <list> statementList optionalStatements subprogramDeclarations programStatements programStatementList
 %type <desc> type
 %type <var> factor term simpleExpression expression variable subprogramHead
 %type <varList> expressionList identifierList parameterList arguments declarations
@@ -149,25 +201,54 @@ int yyerror(char *s) {
 ********************************************************************************
 */
 
-program : MP_PROGRAM MP_ID MP_POPEN identifierList { /* Ignore program parameters */ freeVarList($4); } 
-          MP_PCLOSE MP_SCOLON declarations { /* Install declarations in symbol-table */ installVarList($8); freeVarList($8); } 
-          subprogramDeclarations 
-          compoundStatement 
-          MP_FSTOP MP_EOF 
-          { YYACCEPT; }
+program : MP_PROGRAM MP_ID MP_POPEN identifierList { /* Ignore program parameters */ freeVarList(ctx, $4); } 
+          MP_PCLOSE MP_SCOLON declarations { /* Install declarations in symbol-table. Build (Vector | Scalar) declarations */ 
+                                             SEMANTIC(installVarList(ctx, $8));
+                                             $<num>$ = astDeclarations(ctx, $8);
+                                             freeVarList(ctx, $8); 
+                                             /* Incremental mode: Generate the declarations right away */
+                                             if (ctx->ast.incremental) {
+                                               EMIT(genDeclarations(ctx, $<num>$));
+                                               dropAstNodes(ctx);
+                                             }
+                                           } 
+          subprogramDeclarations           { /* Incremental mode: Generate the main program header and opening brace for C */
+                                             if (ctx->ast.incremental) {
+                                               EMIT(genMainHeader(ctx));
+                                               dropAstNodes(ctx);
+                                             }
+                                           }
+          MP_BEGIN programStatements MP_END MP_FSTOP MP_EOF 
+          { /* Generate the program. In incremental mode only the return statement and closing brace for main remain */
+            if (ctx->ast.incremental) {
+              EMIT(genMainEnd(ctx));
+            } else {
+              ctx->ast.root = astNode(ctx, AST_PROGRAM, UNDEFINED, $<num>9, $10.head, $13.head);
+              EMIT(genProgram(ctx, ctx->ast.root));
+            }
+            YYACCEPT; 
+          }
         ;
 
+programStatements     : programStatementList                            { $$ = $1; }
+                      |                                                 { $$ = astList(); }
+                      ;
+
+programStatementList  : statement                                       { $$ = mainStatement(ctx, astList(), $1); }
+                      | programStatementList MP_SCOLON statement        { $$ = mainStatement(ctx, $1, $3); }
+                      ;
+
 identifierList  : identifier                                          { /* Insert new varType for identifier in a new varList */
-                                                                        $$ = insertVarType(initVarType(UNDEFINED, UNDEFINED, $1), initVarListType()); 
+                                                                        $$ = insertVarType(ctx, initVarType(UNDEFINED, UNDEFINED, $1), initVarListType()); 
                                                                       }
                 | identifierList MP_COMMA identifier                  { /* Insert varType for identifier into varList */
-                                                                        $$ = insertVarType(initVarType(UNDEFINED, UNDEFINED, $3), $1); 
+                                                                        $$ = insertVarType(ctx, initVarType(UNDEFINED, UNDEFINED, $3), $1); 
                                                                       }
                 ;
 
 declarations  : declarations MP_VAR identifierList MP_COLON type MP_SCOLON  { /* Apply token-class and token-types to varType entries in identifierList.
                                                                                  Then append new identifierList to varList of other declarations. */
-                                                                              $$ = appendVarList(mapDescToVarList($5, $3), $1); 
+                                                                              SEMANTIC($$ = appendVarList(ctx, mapDescToVarList($5, $3), $1)); 
                                                                             }
               |                                                             { /* Initialize an empty varList */
                                                                               $$ = initVarListType(); 
@@ -175,10 +256,12 @@ declarations  : declarations MP_VAR identifierList MP_COLON type MP_SCOLON  { /*
               ;
 
 type  : standardType                                                                      { /* Return class scalar of standard token-type */
-                                                                                            $$ = (descType){.tc = TC_SCALAR, .tt = $1}; 
+                                                                                            $$ = (descType){.tc = TC_SCALAR, .tt = $1, .vb = 0, .vl = 0}; 
                                                                                           }
-      | MP_ARRAY MP_BOPEN MP_INTEGER MP_ELLIPSES MP_INTEGER MP_BCLOSE MP_OF standardType  { /* Return class vector of standard token-type */ 
-                                                                                            $$ = (descType){.tc = TC_VECTOR, .tt = $8}; 
+      | MP_ARRAY MP_BOPEN MP_INTEGER                                                      { $<num>$ = atoi(yyget_text(scanner)); } 
+        MP_ELLIPSES MP_INTEGER                                                            { $<num>$ = atoi(yyget_text(scanner)); } 
+        MP_BCLOSE MP_OF standardType                                                      { /* Return class vector of standard token-type */ 
+                                                                                            $$ = (descType){.tc = TC_VECTOR, .tt = $10, .vb = $<num>4, .vl = ($<num>7 - $<num>4 + 1)}; 
                                                                                           }
       ;
 
@@ -186,38 +269,50 @@ standardType  : MP_TYPE_INTEGER
               | MP_TYPE_REAL                                                              { $$ = TT_REAL; }
               ;
 
-subprogramDeclarations  : subprogramDeclarations subprogramDeclaration MP_SCOLON
-                        |
+subprogramDeclarations  : subprogramDeclarations subprogramDeclaration MP_SCOLON  { $$ = astAppend(ctx, $1, $2); }
+                        |                                                       { $$ = astList(); }
                         ;
 
 subprogramDeclaration : subprogramHead declarations { /* Install declarations in symbol-table */
-                                                      installVarList($2);
-                                                      freeVarList($2);
+                                                      SEMANTIC(installVarList(ctx, $2));
+                                                      freeVarList(ctx, $2);
                                                     } 
-                        compoundStatement           { /* If routine is a function, warn if return variable uninitialized  */
-                                                      if ($1.tt != UNDEFINED) {
-                                                        verifyFunctionReturnValue($1.id);
-                                                      }
-                                                      /* Drop scope level after end of body */
-                                                      decrementTableScope(); 
+                        subprogramDeclarations      /* Nested routines */
+                        compoundStatement           { /* If routine is a valid function, warn if return variable uninitialized  */
+                                                      SEMANTIC(
+                                                        if ($1.tc == TC_ROUTINE && $1.tt != UNDEFINED) {
+                                                          verifyFunctionReturnValue(ctx, $1.id);
+                                                        }
+                                                        /* Drop scope level after end of body */
+                                                        decrementTableScope(ctx);
+                                                      );
+                                                      $$ = astNode(ctx, AST_ROUTINE, UNDEFINED, $1.id, $4.head, $5);
                                                     }
                       ;
 
-subprogramHead  : MP_FUNCTION identifier arguments MP_COLON standardType MP_SCOLON  { /* Attempt to install function and arguments */
-                                                                                      if (installRoutine($2, $5)) {
-                                                                                        incrementTableScope();
-                                                                                        installRoutineArgs($2, $3);
-                                                                                      }
-                                                                                      freeVarList($3);
-                                                                                      $$ = initVarType(TC_ROUTINE, $5, $2);
+subprogramHead  : MP_FUNCTION identifier arguments MP_COLON standardType MP_SCOLON  { /* Attempt to install function and arguments. The body is scoped regardless */
+                                                                                      unsigned installed;
+                                                                                      SEMANTIC(
+                                                                                        installed = installRoutine(ctx, $2, $5);
+                                                                                        incrementTableScope(ctx);
+                                                                                        if (installed) {
+                                                                                          installRoutineArgs(ctx, $2, $3);
+                                                                                        }
+                                                                                      );
+                                                                                      freeVarList(ctx, $3);
+                                                                                      $$ = initVarType(installed ? TC_ROUTINE : UNDEFINED, $5, $2);
                                                                                     }
-                | MP_PROCEDURE identifier arguments MP_SCOLON                       { /* Attempt to install procedure and arguments */
-                                                                                      if (installRoutine($2, UNDEFINED)) {
-                                                                                        incrementTableScope();
-                                                                                        installRoutineArgs($2, $3);
-                                                                                      }
-                                                                                      freeVarList($3);
-                                                                                      $$ = initVarType(TC_ROUTINE, UNDEFINED, $2);
+                | MP_PROCEDURE identifier arguments MP_SCOLON                       { /* Attempt to install procedure and arguments. The body is scoped regardless */
+                                                                                      unsigned installed;
+                                                                                      SEMANTIC(
+                                                                                        installed = installRoutine(ctx, $2, UNDEFINED);
+                                                                                        incrementTableScope(ctx);
+                                                                                        if (installed) {
+                                                                                          installRoutineArgs(ctx, $2, $3);
+                                                                                        }
+                                                                                      );
+                                                                                      freeVarList(ctx, $3);
+                                                                                      $$ = initVarType(installed ? TC_ROUTINE : UNDEFINED, UNDEFINED, $2);
                                                                                     }                     
                 ;
 
@@ -226,129 +321,184 @@ arguments : MP_POPEN parameterList MP_PCLOSE                      { $$ = $2; }
           ;
 
 parameterList : identifierList MP_COLON type                          { /* Map a descType (token-class,token-type) to varList of identifiers */
-                                                                        $$ = mapDescToVarList($3, $1); 
+                                                                        SEMANTIC($$ = mapDescToVarList($3, $1)); 
                                                                       }                     
               | parameterList MP_SCOLON identifierList MP_COLON type  { /* Map descType to identifierList, and append to parameter varList */
-                                                                        $$ = appendVarList(mapDescToVarList($5, $3), $1); 
+                                                                        SEMANTIC($$ = appendVarList(ctx, mapDescToVarList($5, $3), $1)); 
                                                                       }
               ;
 
-compoundStatement : MP_BEGIN optionalStatements MP_END    
+compoundStatement : MP_BEGIN optionalStatements MP_END          { $$ = astNode(ctx, AST_BLOCK, UNDEFINED, $2.head, AST_NONE, AST_NONE); }
                   ;
 
 optionalStatements  : statementList                               { $$ = $1; }                              
-                    |                                             { $$ = 0; }                                               
+                    |                                             { $$ = astList(); }                                               
                     ;
 
-statementList : statement                                         { $$ = 1; }                    
-              | statementList MP_SCOLON statement                 { $$ = $1 + 1; } 
+statementList : statement                                         { $$ = astAppend(ctx, astList(), $1); }                    
+              | statementList MP_SCOLON statement                 { $$ = astAppend(ctx, $1, $3); } 
               ;
 
-statement : variable MP_ASSIGNOP expression                       { /* Verify expression may be assigned to variable.*/
-                                                                    verifyAssignment($1, $3); 
+statement : variable MP_ASSIGNOP expression                       { /* Verify expression may be assigned to variable */
+                                                                    SEMANTIC(verifyAssignment(ctx, $1, $3)); 
+                                                                    $$ = astNode(ctx, AST_ASSIGN, UNDEFINED, $1.node, $3.node, AST_NONE);
                                                                   }                 
-          | procedureStatement
-          | compoundStatement
-          | MP_IF expression MP_THEN statement MP_ELSE statement  { /* Verify boolean guard expression is of Integer token-type */
-                                                                    verifyGuardExprVar($2); 
-                                                                  }
-          | MP_WHILE expression MP_DO statement                   { verifyGuardExprVar($2); }             
+          | procedureStatement                                    { $$ = $1; }
+          | compoundStatement                                     { $$ = $1; }
+          | MP_IF expression  { /* Verify boolean guard expression is of Integer token-type */
+                                SEMANTIC(verifyGuardExprVar(ctx, $2)); 
+                              }
+            MP_THEN statement 
+            MP_ELSE statement { $$ = astNode(ctx, AST_IF, UNDEFINED, $2.node, $5, $7); }
+          | MP_WHILE 
+            expression        { SEMANTIC(verifyGuardExprVar(ctx, $2)); }  
+            MP_DO statement   { $$ = astNode(ctx, AST_WHILE, UNDEFINED, $2.node, $5, AST_NONE); }             
           ;
 
 variable  : identifier                                            { /* Expect scalar id entry in symbol-table. Else install as undefined */
-                                                                    if (existsId($1, TC_SCALAR)) {
-                                                                      $$ = initVarTypeFromId($1, TC_SCALAR); 
-                                                                    } else {
-                                                                      $$ = initVarType(UNDEFINED, UNDEFINED, $1);
-                                                                    }
+                                                                    SEMANTIC(
+                                                                      if (existsId(ctx, $1, TC_SCALAR)) {
+                                                                        $$ = initVarTypeFromId(ctx, $1, TC_SCALAR); 
+                                                                      } else {
+                                                                        $$ = initVarType(UNDEFINED, UNDEFINED, $1);
+                                                                      }
+                                                                    );
+                                                                    $$.node = astExpression(ctx, AST_ID, UNDEFINED, $1, AST_NONE, AST_NONE, $$);
                                                                   }                                                                                     
           | identifier MP_BOPEN expression MP_BCLOSE              { /* Expect vector id entry in symbol-table. Else install as undefined */
-                                                                    if (existsId($1, TC_VECTOR)) {
-                                                                      requireExprVarType(TC_SCALAR, TT_INTEGER, $3); 
-                                                                      $$ = initVarType(TC_VECTOR, getIdTokenType($1, TC_VECTOR), $1);
-                                                                    }
+                                                                    unsigned vb = 0;
+                                                                    SEMANTIC(
+                                                                      if (existsId(ctx, $1, TC_VECTOR)) {
+                                                                        requireExprVarType(ctx, TC_SCALAR, TT_INTEGER, $3); 
+                                                                        $$ = initVarType(TC_VECTOR, getIdTokenType(ctx, $1, TC_VECTOR), $1);
+                                                                        /* Extract IdEntry to obtain lower-bound information. */
+                                                                        vb = containsIdEntry(ctx, $1, TC_VECTOR, SYMTAB_SCOPE_ALL)->vb;
+                                                                      } else {
+                                                                        $$ = initVarType(UNDEFINED, UNDEFINED, $1);
+                                                                      }
+                                                                    );
+                                                                    $$.node = astExpression(ctx, AST_INDEX, UNDEFINED, $1, $3.node, vb, $$);
                                                                   } 
                                                                                    
-procedureStatement  : identifier                                 
-                    | identifier MP_POPEN expressionList MP_PCLOSE  { /* Verify call to routine is valid */
-                                                                      if (existsId($1, TC_ROUTINE)) { 
-                                                                        verifyRoutineArgs($1, $3); 
+procedureStatement  : identifier                                    { $$ = astNode(ctx, AST_CALL, UNDEFINED, $1, AST_NONE, AST_NONE); }
+                    | identifier MP_POPEN expressionList MP_PCLOSE  { /* Verify call to routine is valid. Code generation for calls is unavailable */
+                                                                      SEMANTIC(
+                                                                        if (existsId(ctx, $1, TC_ROUTINE)) { 
+                                                                          verifyRoutineArgs(ctx, $1, $3); 
+                                                                        }
+                                                                      );
+                                                                      if (GENERATE) {
+                                                                        printError(ctx, "Procedure calls are not available!");
                                                                       }
-                                                                      freeVarList($3);
+                                                                      $$ = astNode(ctx, AST_CALL, UNDEFINED, $1, astExpressionList(ctx, $3), AST_NONE);
+                                                                      freeVarList(ctx, $3);
                                                                     }
-                    | MP_READLN MP_POPEN expressionList MP_PCLOSE   { /* Verify arguments for readln. */
-                                                                      verifyReadlnArgs($3);
-                                                                      freeVarList($3);
+                    | MP_READLN MP_POPEN expressionList MP_PCLOSE   { /* Verify arguments for readln. Generated as a scanf in C */
+                                                                      SEMANTIC(verifyReadlnArgs(ctx, $3));
+                                                                      $$ = astNode(ctx, AST_READLN, UNDEFINED, astExpressionList(ctx, $3), AST_NONE, AST_NONE);
+                                                                      freeVarList(ctx, $3);
                                                                     }
-                    | MP_WRITELN MP_POPEN expressionList MP_PCLOSE  { /* Verify arguments for writeln. */
-                                                                      verifyWritelnArgs($3);
-                                                                      freeVarList($3);
+                    | MP_WRITELN MP_POPEN expressionList MP_PCLOSE  { /* Verify arguments for writeln. Generated as a printf in C */
+                                                                      SEMANTIC(verifyWritelnArgs(ctx, $3));
+                                                                      $$ = astNode(ctx, AST_WRITELN, UNDEFINED, astExpressionList(ctx, $3), AST_NONE, AST_NONE);
+                                                                      freeVarList(ctx, $3);
                                                                     }
                     ;
 
-expressionList  : expression                                      { $$ = insertVarType($1, initVarListType()); }                                                              
-                | expressionList MP_COMMA expression              { $$ = insertVarType($3, $1); }                
+expressionList  : expression                                      { $$ = insertVarType(ctx, $1, initVarListType()); }                                                              
+                | expressionList MP_COMMA expression              { $$ = insertVarType(ctx, $3, $1); }                
                 ;
 
 expression  : simpleExpression                                    { $$ = $1; }
-            | simpleExpression MP_RELOP_LT simpleExpression       { /* Check boolean expression types and attempt to resolve/fold expression */
-                                                                    $$ = resolveBooleanOperation(MP_RELOP_LT, $1, $3); 
+            | simpleExpression relop simpleExpression             { /* Check boolean expression types and attempt to resolve/fold expression.
+                                                                       The boolean operator is kept in the node for proper if-else conditional generation */
+                                                                    SEMANTIC($$ = resolveBooleanOperation(ctx, $2, $1, $3)); 
+                                                                    $$.node = astExpression(ctx, AST_COMPARE, $2, $1.node, $3.node, AST_NONE, $$);
                                                                   }
-            | simpleExpression MP_RELOP_LE simpleExpression       { $$ = resolveBooleanOperation(MP_RELOP_LE, $1, $3); }
-            | simpleExpression MP_RELOP_EQ simpleExpression       { $$ = resolveBooleanOperation(MP_RELOP_EQ, $1, $3); }
-            | simpleExpression MP_RELOP_GE simpleExpression       { $$ = resolveBooleanOperation(MP_RELOP_GE, $1, $3); }
-            | simpleExpression MP_RELOP_GT simpleExpression       { $$ = resolveBooleanOperation(MP_RELOP_GT, $1, $3); }
-            | simpleExpression MP_RELOP_NE simpleExpression       { $$ = resolveBooleanOperation(MP_RELOP_NE, $1, $3); }
             ;
 
+relop : MP_RELOP_LT                                               { $$ = MP_RELOP_LT; }
+      | MP_RELOP_LE                                               { $$ = MP_RELOP_LE; }
+      | MP_RELOP_EQ                                               { $$ = MP_RELOP_EQ; }
+      | MP_RELOP_GE                                               { $$ = MP_RELOP_GE; }
+      | MP_RELOP_GT                                               { $$ = MP_RELOP_GT; }
+      | MP_RELOP_NE                                               { $$ = MP_RELOP_NE; }
+      ;
+
 simpleExpression  : term                                          { $$ = $1; }
                   | sign term                                     { /* Apply a sign to the term if constant. */
-                                                                    $$ = applySign($1, $2); 
+                                                                    SEMANTIC($$ = applySign(ctx, $1, $2)); 
+                                                                    $$.node = astExpression(ctx, AST_UNARY, $1, $2.node, AST_NONE, AST_NONE, $$);
                                                                   }
                   | simpleExpression sign term                    { /* Check arithmetic expression types and attempt to resolve/fold expression */
-                                                                    $$ = resolveArithmeticOperation($2, $1, $3); 
+                                                                    SEMANTIC($$ = resolveArithmeticOperation(ctx, $2, $1, $3)); 
+                                                                    $$.node = astExpression(ctx, AST_BINARY, $2, $1.node, $3.node, AST_NONE, $$);
                                                                   }
                   ;
 
 term  : factor                                                    { $$ = $1; }
-      | term MP_MULOP factor                                      { $$ = resolveArithmeticOperation(MP_MULOP, $1, $3); }
+      | term MP_MULOP factor                                      { SEMANTIC($$ = resolveArithmeticOperation(ctx, MP_MULOP, $1, $3)); 
+                                                                    $$.node = astExpression(ctx, AST_BINARY, MP_MULOP, $1.node, $3.node, AST_NONE, $$);
+                                                                  }
       | term MP_DIVOP factor                                      { /* Check expression types and attempt to resolve/fold expression. Check for div-zero */
-                                                                    $$ = resolveArithmeticOperation(MP_DIVOP, $1, $3); 
+                                                                    SEMANTIC($$ = resolveArithmeticOperation(ctx, MP_DIVOP, $1, $3)); 
+                                                                    $$.node = astExpression(ctx, AST_BINARY, MP_DIVOP, $1.node, $3.node, AST_NONE, $$);
+                                                                  }
+      | term MP_MODOP factor                                      { /* Type promotion is illogical for modulo. Result is always generated as integer. */ 
+                                                                    SEMANTIC($$ = resolveArithmeticOperation(ctx, MP_MODOP, $1, $3)); 
+                                                                    $$.node = astExpression(ctx, AST_BINARY, MP_MODOP, $1.node, $3.node, AST_NONE, $$);
                                                                   }
-      | term MP_MODOP factor                                      { $$ = resolveArithmeticOperation(MP_MODOP, $1, $3); }
       ;
 
 factor  : identifier                                              { /* Verify variable factor exists. Initialization check is postponed until usage */
-                                                                    if (existsId($1, TC_ANY)) {
-                                                                      $$ = initVarTypeFromId($1, TC_ANY);
-                                                                    } else { 
-                                                                      $$ = initExprVarType(UNDEFINED, UNDEFINED, NIL); 
-                                                                    }
+                                                                    SEMANTIC(
+                                                                      if (existsId(ctx, $1, TC_ANY)) {
+                                                                        $$ = initVarTypeFromId(ctx, $1, TC_ANY);
+                                                                      } else { 
+                                                                        $$ = initExprVarType(UNDEFINED, UNDEFINED, NIL); 
+                                                                      }
+                                                                    );
+                                                                    $$.node = astExpression(ctx, AST_ID, UNDEFINED, $1, AST_NONE, AST_NONE, $$);
                                                                   }
-        | identifier MP_POPEN expressionList MP_PCLOSE            { /* Verify routine factor exists, and has proper arguments */
-                                                                    if (existsId($1, TC_ROUTINE)) { 
-                                                                      verifyRoutineArgs($1, $3);
-                                                                      $$ = initExprVarType(TC_SCALAR, getIdTokenType($1, TC_ROUTINE), NIL); 
-                                                                    } else {
-                                                                      $$ = initExprVarType(UNDEFINED, UNDEFINED, NIL);
+        | identifier MP_POPEN expressionList MP_PCLOSE            { /* Verify routine factor exists, and has proper arguments. Code generation for calls is unavailable */
+                                                                    SEMANTIC(
+                                                                      if (existsId(ctx, $1, TC_ROUTINE)) { 
+                                                                        verifyRoutineArgs(ctx, $1, $3);
+                                                                        $$ = initExprVarType(TC_SCALAR, getIdTokenType(ctx, $1, TC_ROUTINE), NIL); 
+                                                                      } else {
+                                                                        $$ = initExprVarType(UNDEFINED, UNDEFINED, NIL);
+                                                                      }
+                                                                    );
+                                                                    if (GENERATE) {
+                                                                      printError(ctx, "Function calls are not available!");
                                                                     }
-                                                                    freeVarList($3);
+                                                                    $$.node = astExpression(ctx, AST_CALL, UNDEFINED, $1, astExpressionList(ctx, $3), AST_NONE, $$);
+                                                                    freeVarList(ctx, $3);
                                                                   }
-        | identifier MP_BOPEN expression MP_BCLOSE                { /* Verify vector factor exists, and indexing expression-variable is valid */
-                                                                    if (existsId($1, TC_VECTOR)) {
-                                                                      requireExprVarType(TC_SCALAR, TT_INTEGER, $3);
-                                                                      $$ = initExprVarType(TC_SCALAR, getIdTokenType($1, TC_VECTOR), NIL);
-                                                                    } else {
-                                                                      $$ = initExprVarType(UNDEFINED, UNDEFINED, NIL);
-                                                                    }
+        | identifier MP_BOPEN expression MP_BCLOSE                { /* Verify vector factor exists, and indexing expression-variable is valid. Keep its lower bound for indexing */
+                                                                    unsigned vb = 0;
+                                                                    SEMANTIC(
+                                                                      if (existsId(ctx, $1, TC_VECTOR)) {
+                                                                        requireExprVarType(ctx, TC_SCALAR, TT_INTEGER, $3);
+                                                                        $$ = initExprVarType(TC_SCALAR, getIdTokenType(ctx, $1, TC_VECTOR), NIL);
+                                                                        vb = containsIdEntry(ctx, $1, TC_VECTOR, SYMTAB_SCOPE_ALL)->vb;
+                                                                      } else {
+                                                                        $$ = initExprVarType(UNDEFINED, UNDEFINED, NIL);
+                                                                      }
+                                                                    );
+                                                                    $$.node = astExpression(ctx, AST_INDEX, UNDEFINED, $1, $3.node, vb, $$);
                                                                   } 
-        | MP_INTEGER                                              { $$ = initExprVarType(TC_SCALAR, TT_INTEGER, installNumber(atof(yytext))); }
-        | MP_REAL                                                 { $$ = initExprVarType(TC_SCALAR, TT_REAL, installNumber(atof(yytext))); }
+        | MP_INTEGER                                              { SEMANTIC($$ = initExprVarType(TC_SCALAR, TT_INTEGER, installIntegerLiteral(ctx, yyget_text(scanner), yyget_leng(scanner)))); 
+                                                                    $$.node = astExpression(ctx, AST_CONST, UNDEFINED, AST_NONE, AST_NONE, AST_NONE, $$);
+                                                                  }
+        | MP_REAL                                                 { SEMANTIC($$ = initExprVarType(TC_SCALAR, TT_REAL, installReal(ctx, realLexeme(scanner)))); 
+                                                                    $$.node = astExpression(ctx, AST_CONST, UNDEFINED, AST_NONE, AST_NONE, AST_NONE, $$);
+                                                                  }
         | MP_POPEN expression MP_PCLOSE                           { $$ = $2; }
         ;
 
 identifier : MP_ID                                                { /* Dedicated rule is necessary to properly install token lexemes */
-                                                                    $$ = installId(yytext); 
+                                                                    $$ = installIdSpan(ctx, yyget_text(scanner), yyget_leng(scanner)); 
                                                                   }
 
 sign  : MP_ADDOP                                                  { $$ = MP_ADDOP; }
@@ -357,74 +507,3 @@ sign  : MP_ADDOP                                                  { $$ = MP_ADDO
 
 
 %%
-
-/*
- ********************************************************************************
- *                                  C Routines
- ********************************************************************************
- */
-
-/* Simply usage manual */
- #define MP_USAGE   "\nSupported Program Flags:\n \
-\t-d : Debug Mode. Outputs file while parsing.\n \
-\t-q : Quiet Mode. Surpresses all warnings.\n \
-\t-c : Color Mode. All output (and syntax) has\n \
-\t     color.\n\n"
-
-/* Parses program argument vector for program flags.
- * Supported flags: 
- * -c : Color Mode. Semantic Analysis output is color-formatted.
- * -d : Debug Mode. Outputs lines as they are parsed. Useful for syntax errors.
- * -q : Quiet Mode. Disabled all warnings.
- */
-void parseArguments (int argc, char *argv[]) {
-  char *arg;
-
-  while (--argc && *(arg = *++argv) == '-') {
-    switch (*++arg) {
-      case 'c':
-        inColor = 1;
-        break;
-      case 'd':
-        inDebug = 1; 
-        break;
-      case 'h':
-        fprintf(stdout, MP_USAGE);
-        break;
-      case 'q':
-        inQuiet = 1;
-        break;
-      default:
-        fprintf(stderr, "Unknown argument \"-%s\"!\n", arg);
-        fprintf(stderr, "%s", MP_USAGE);
-        exit(EXIT_FAILURE);
-        break;
-    }
-  }
-}
-
-int main(int argc, char *argv[]) {
-
-  // Initialize supporting tables.
-  initStringTable();
-  initNumberTable();
-
-  // Read program flags
-  if (argc > 1) {
-    parseArguments(argc, argv);
-  }
-
-  // Perform Syntactic + Symantic Analysis.
-  yyparse();
-
-  // Free allocate memory.
-  freeNumberTable();
-  freeStringTable();
-  freeSymbolTables();
-
-  // Free Flex memory.
-  yylex_destroy();
-  
-  return (isError != 0 ? EXIT_FAILURE : EXIT_SUCCESS);
-}
-
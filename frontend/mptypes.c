@@ -1,4 +1,45 @@
-#include "mptypes.h"
+#include <string.h>
+#include "context.h"
+
+/*
+********************************************************************************
+*                              Symbolic Constants                              *
+********************************************************************************
+*/
+
+#define VARLIST_DEFAULT_SIZE    8
+
+/*
+********************************************************************************
+*                           Internal List Functions                            *
+********************************************************************************
+*/
+
+/* Ensures the list has room for `length` varTypes, doubling its size as needed.
+ * Lists are mostly built and released in stack order, so most growth happens
+ * in place. */
+static varListType reserveVarList (Arena *arena, varListType varList, unsigned length) {
+    unsigned size = (varList.size == 0 ? VARLIST_DEFAULT_SIZE : varList.size);
+    varType *list;
+
+    if (length <= varList.size) {
+        return varList;
+    }
+    while (size < length) {
+        size *= 2;
+    }
+
+    // (*). Grow in place if the list is the most recent allocation. Else move it.
+    if (!arenaExtend(arena, varList.list, varList.size * sizeof(varType), size * sizeof(varType))) {
+        list = arenaAlloc(arena, size * sizeof(varType));
+        if (varList.length > 0) {
+            memcpy(list, varList.list, varList.length * sizeof(varType));
+        }
+        varList.list = list;
+    }
+    varList.size = size;
+    return varList;
+}
 
 /*
 ********************************************************************************
@@ -37,14 +78,14 @@ const char *tokenClassName (unsigned tc) {
  * identifier-index (id).
 */
 varType initVarType (unsigned tc, unsigned tt, unsigned id) {
-    return (varType){.tc = tc, .tt = tt, .vi = NIL, .id = id};
+    return (varType){.tc = tc, .tt = tt, .vi = NIL, .id = id, .vb = 0, .vl = 0, .node = 0};
 }
 
 /* Initializes a new expression varType with the given tokenc-class (tc), 
  * token-type (tt), and value-index (vi). This type has no symbol table entry.
 */
 varType initExprVarType (unsigned tc, unsigned tt, unsigned vi) {
-    return (varType){.tc = tc, .tt = tt, .vi = vi, .id = NIL};
+    return (varType){.tc = tc, .tt = tt, .vi = vi, .id = NIL, .vb = 0, .vl = 0, .node = 0};
 }
 
 /*
@@ -53,48 +94,65 @@ varType initExprVarType (unsigned tc, unsigned tt, unsigned vi) {
 ********************************************************************************
 */
 
+/* Empties the list arena. Lists of the previous compilation become invalid */
+void initVarListArena (CompileContext *ctx) {
+    arenaReset(&ctx->lists);
+}
+
+/* Frees the list arena */
+void freeVarListArena (CompileContext *ctx) {
+    arenaFree(&ctx->lists);
+}
+
 /* Initializes a new varListType */
 varListType initVarListType (void) {
-    return (varListType){.length = 0, .list = NULL};
+    return (varListType){.length = 0, .size = 0, .list = NULL};
 }
 
-/* Frees allocated memory in a varListType */
-void freeVarList(varListType varList) {
-    free(varList.list);
+/* Releases the memory of a varListType. Memory is reclaimed right away if the
+ * list is the most recent arena allocation, else on the next compilation */
+void freeVarList (CompileContext *ctx, varListType varList) {
+    arenaRelease(&ctx->lists, varList.list, varList.size * sizeof(varType));
 }
 
-/* Allocates a copy of the given varType and places it in returned varList list. */
-varListType insertVarType (varType var, varListType varList) {
-    
-    if ((varList.list = realloc(varList.list, (varList.length + 1) * sizeof(varType))) == NULL) {
-        fprintf(stderr, "Error: insertVarType: List reallocation failed!\n");
-        exit(EXIT_FAILURE);
-    }
-
+/* Places a copy of the given varType in returned varList list. Lists grow
+ * geometrically, in place where possible. */
+varListType insertVarType (CompileContext *ctx, varType var, varListType varList) {
+    varList = reserveVarList(&ctx->lists, varList, varList.length + 1);
     varList.list[varList.length++] = var;
-    
     return varList;
 }
 
-/* Appends the first varListType list to second varListType */
-varListType appendVarList (varListType suffix, varListType prefix) {
-
-    // Compute new length of prefix.
-    prefix.length += suffix.length;
+/* Appends the first varListType list to second varListType. The first list
+ * is released */
+varListType appendVarList (CompileContext *ctx, varListType suffix, varListType prefix) {
+    size_t prefixBytes = ARENA_ROUND(prefix.size * sizeof(varType));
 
-    // Reallocate prefix list.
-    if ((prefix.list = realloc(prefix.list, prefix.length * sizeof(varType))) == NULL) {
-        fprintf(stderr, "Error: appendVarList: List reallocation failed!\n");
-        exit(EXIT_FAILURE);
+    // (1). An empty prefix is replaced by the suffix. An empty suffix adds nothing.
+    if (prefix.list == NULL) {
+        return suffix;
     }
-
-    // Append copies of varTypes to prefix list.
-    for (int i = 0; i < suffix.length; i++) {
-        prefix.list[prefix.length - suffix.length + i] = suffix.list[i];
+    if (suffix.list == NULL) {
+        return prefix;
     }
 
-    // Free suffix list.
-    free(suffix.list);
+    // (2). If the suffix was allocated directly after the prefix, slide it down
+    //      and let the prefix absorb its memory.
+    if ((char *)prefix.list + prefixBytes == (char *)suffix.list &&
+        arenaIsTop(&ctx->lists, suffix.list, suffix.size * sizeof(varType))) {
+        memmove(prefix.list + prefix.length, suffix.list, suffix.length * sizeof(varType));
+        arenaRelease(&ctx->lists, suffix.list, suffix.size * sizeof(varType));
+        arenaExtend(&ctx->lists, prefix.list, prefix.size * sizeof(varType),
+            (prefix.size + suffix.size) * sizeof(varType));
+        prefix.size += suffix.size;
+        prefix.length += suffix.length;
+        return prefix;
+    }
 
-    return prefix;   
+    // (3). Otherwise copy the suffix into the (grown) prefix.
+    prefix = reserveVarList(&ctx->lists, prefix, prefix.length + suffix.length);
+    memcpy(prefix.list + prefix.length, suffix.list, suffix.length * sizeof(varType));
+    prefix.length += suffix.length;
+    freeVarList(ctx, suffix);
+    return prefix;
 }
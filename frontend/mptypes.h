@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include "arena.h"
 
 /*
     ***************************************************************************
@@ -39,10 +40,15 @@
 ********************************************************************************
 */
 
+// The context of a compilation (see context.h).
+typedef struct compileContext CompileContext;
+
 // YYSTYPE: Descriptor data type.
 typedef struct {
     unsigned tc;            // Token-Class.
     unsigned tt;            // Token-Type.
+    unsigned vb;            // Vector-Bound.
+    unsigned vl;            // Vector-Length.
 } descType;
 
 // YYSTYPE: Variable data type.
@@ -51,12 +57,16 @@ typedef struct {
     unsigned tt;            // Token-Type.
     unsigned vi;            // Value-Index: Index of constant value in numtab.
     unsigned id;            // Identifier-Index: Index of the identifier in strtab.
+    unsigned vb;            // Vector-Bound: Lower boundary of a vector.
+    unsigned vl;            // Vector-Length: Length of a vector.
+    unsigned node;          // Node: Expression or variable in the syntax tree (see ast.h).
 } varType;
 
 // YYSTYPE: Variable-List data type.
 typedef struct {
     unsigned length;        // Length of list.
-    varType *list;          // Allocated list.
+    unsigned size;          // Allocated length of list.
+    varType *list;          // List, allocated from the list arena.
 } varListType;
 
 /*
@@ -93,16 +103,25 @@ varType initExprVarType (unsigned tc, unsigned tt, unsigned vi);
 ********************************************************************************
 */
 
+/* Empties the list arena. Lists of the previous compilation become invalid */
+void initVarListArena (CompileContext *ctx);
+
+/* Frees the list arena */
+void freeVarListArena (CompileContext *ctx);
+
 /* Initializes a new varListType */
 varListType initVarListType (void);
 
-/* Frees allocated memory in a varListType */
-void freeVarList(varListType varList);
+/* Releases the memory of a varListType. Memory is reclaimed right away if the
+ * list is the most recent arena allocation, else on the next compilation */
+void freeVarList (CompileContext *ctx, varListType varList);
 
-/* Allocates a copy of the given varType and places it in returned varList list. */
-varListType insertVarType (varType var, varListType varList);
+/* Places a copy of the given varType in returned varList list. Lists grow
+ * geometrically, in place where possible. */
+varListType insertVarType (CompileContext *ctx, varType var, varListType varList);
 
-/* Appends the first varListType list to second varListType */
-varListType appendVarList (varListType suffix, varListType prefix);
+/* Appends the first varListType list to second varListType. The first list
+ * is released */
+varListType appendVarList (CompileContext *ctx, varListType suffix, varListType prefix);
 
 #endif
\ No newline at end of file
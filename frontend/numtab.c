@@ -1,4 +1,4 @@
-#include "numtab.h"
+#include "context.h"
 
 /*
 ********************************************************************************
@@ -6,13 +6,14 @@
 ********************************************************************************
 */
 
-#define NUMTAB_DEFAULT_SIZE     512
+#define NUMTAB_DEFAULT_SIZE     256
 
-// Number table.
-double *numTable;
-
-// Points to the front of the concatenated string table.
-unsigned np, numTableSize;
+// Value-indices hold the position of a constant in its pool, shifted left by
+// one. The low bit selects the pool.
+#define NUMTAB_INTEGER          0
+#define NUMTAB_REAL             1
+#define POOL(vi)                ((vi) & 1)
+#define POSITION(vi)            ((vi) >> 1)
 
 /*
 ********************************************************************************
@@ -20,17 +21,85 @@ unsigned np, numTableSize;
 ********************************************************************************
 */
 
-static void resizeNumberTable (unsigned newSize) {
-    if (newSize < numTableSize) {
-        fprintf(stderr, "Error: numtab: Can't resize table to smaller size!\n");
+/* Returns the hash of a constant's bits (the finalizer of SplitMix64). */
+static unsigned hashBits (unsigned long long x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return (unsigned)(x ^ (x >> 31));
+}
+
+/* Allocates an empty index of `size` slots and reinserts all constants of the pool. */
+static void resizePoolIndex (NumberPool *pool, unsigned size) {
+    unsigned mask = size - 1, i;
+
+    free(pool->index);
+    if ((pool->index = calloc(size, sizeof(unsigned))) == NULL) {
+        fprintf(stderr, "Error: numtab: Couldn't allocate index!\n");
         exit(EXIT_FAILURE);
     }
+    pool->indexSize = size;
 
-    if ((numTable = realloc(numTable, newSize * sizeof(double))) == NULL) {
-        fprintf(stderr, "Error: numtab: Couldn't resize number table!\n");
+    for (unsigned p = 0; p < pool->count; p++) {
+        i = hashBits(pool->values[p].bits) & mask;
+        while (pool->index[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        pool->index[i] = p + 1;
+    }
+}
+
+/* Empties the pool, allocating it on first use. */
+static void initPool (NumberPool *pool) {
+    pool->count = 0;
+    if (pool->values != NULL) {
+        memset(pool->index, 0, pool->indexSize * sizeof(unsigned));
+        return;
+    }
+    pool->size = NUMTAB_DEFAULT_SIZE;
+    if ((pool->values = malloc(pool->size * sizeof(numType))) == NULL) {
+        fprintf(stderr, "Error: numtab: Couldn't allocate table!\n");
         exit(EXIT_FAILURE);
     }
-    numTableSize = newSize;
+    resizePoolIndex(pool, 2 * NUMTAB_DEFAULT_SIZE);
+}
+
+/* Returns the value-index of constant `n` in the pool `kind`. Installs it if new. */
+static unsigned installInPool (NumberTable *nt, unsigned kind, numType n) {
+    NumberPool *pool = nt->pools + kind;
+    unsigned mask = pool->indexSize - 1, i = hashBits(n.bits) & mask, p;
+
+    // (1). Return the existing constant, if any.
+    while ((p = pool->index[i]) != 0) {
+        if (pool->values[p - 1].bits == n.bits) {
+            return ((p - 1) << 1) | kind;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // (2). Append the constant. Keep the index at most half full.
+    if (pool->count >= pool->size) {
+        if ((pool->values = realloc(pool->values, 2 * pool->size * sizeof(numType))) == NULL) {
+            fprintf(stderr, "Error: numtab: Couldn't resize number table!\n");
+            exit(EXIT_FAILURE);
+        }
+        pool->size *= 2;
+    }
+    p = pool->count++;
+    pool->values[p] = n;
+    pool->index[i] = p + 1;
+    if (pool->count > pool->indexSize / 2) {
+        resizePoolIndex(pool, 2 * pool->indexSize);
+    }
+    return (p << 1) | kind;
+}
+
+/* Returns the constant at value-index `vi` if it lies in pool `kind`, else NULL. */
+static numType *constantAtIndex (NumberTable *nt, unsigned kind, unsigned vi) {
+    NumberPool *pool = nt->pools + kind;
+    if (vi == (unsigned)-1 || POOL(vi) != kind || POSITION(vi) >= pool->count) {
+        return NULL;
+    }
+    return pool->values + POSITION(vi);
 }
 
 /*
@@ -39,45 +108,77 @@ static void resizeNumberTable (unsigned newSize) {
 ********************************************************************************
 */
 
-/* Initializes the number table */
-void initNumberTable () {
-    numTableSize = NUMTAB_DEFAULT_SIZE;
-    if ((numTable = malloc(numTableSize * sizeof(double))) == NULL) {
-        fprintf(stderr, "Error: numtab: Couldn't allocate table!\n");
-        exit(EXIT_FAILURE);
-    }
+/* Initializes the number table. An existing table is emptied, keeping its allocation */
+void initNumberTable (CompileContext *ctx) {
+    initPool(ctx->numtab.pools + NUMTAB_INTEGER);
+    initPool(ctx->numtab.pools + NUMTAB_REAL);
 }
 
-/* Installs given constant in the table and returns its index */
-unsigned installNumber (double n) {
-    if (np >= numTableSize) {
-        resizeNumberTable(2 * numTableSize);
-    }
-    numTable[np++] = n;
-    return (np - 1);
+/* Installs given integer constant and returns its value-index. Equal integers share one */
+unsigned installInteger (CompileContext *ctx, long long n) {
+    return installInPool(&ctx->numtab, NUMTAB_INTEGER, (numType){.i = n});
 }
 
-/* Returns pointer to constant at given index in the string table. */
-double *numberAtIndex (unsigned vi) {
-    if (vi >= np) {
-        return NULL;
+/* Installs given real constant and returns its value-index. Reals with equal bits share one */
+unsigned installReal (CompileContext *ctx, double n) {
+    return installInPool(&ctx->numtab, NUMTAB_REAL, (numType){.r = n});
+}
+
+/* Returns pointer to the integer at given value-index. NULL if none or not an integer */
+long long *integerAtIndex (CompileContext *ctx, unsigned vi) {
+    numType *n = constantAtIndex(&ctx->numtab, NUMTAB_INTEGER, vi);
+    return (n == NULL ? NULL : &n->i);
+}
+
+/* Returns pointer to the real at given value-index. NULL if none or not a real */
+double *realAtIndex (CompileContext *ctx, unsigned vi) {
+    numType *n = constantAtIndex(&ctx->numtab, NUMTAB_REAL, vi);
+    return (n == NULL ? NULL : &n->r);
+}
+
+/* Stores the constant at given value-index in `n`, converting integers to reals.
+ * Returns zero if there is no constant at the index. */
+int numberAtIndex (CompileContext *ctx, unsigned vi, double *n) {
+    numType *c;
+    if ((c = constantAtIndex(&ctx->numtab, NUMTAB_INTEGER, vi)) != NULL) {
+        *n = (double)c->i;
+        return 1;
     }
-    return numTable + vi;
+    if ((c = constantAtIndex(&ctx->numtab, NUMTAB_REAL, vi)) != NULL) {
+        *n = c->r;
+        return 1;
+    }
+    return 0;
+}
+
+/* Returns the number of constants in use, storing the allocated count in `size` */
+unsigned numberTableUsage (CompileContext *ctx, unsigned *size) {
+    NumberPool *pools = ctx->numtab.pools;
+    *size = pools[NUMTAB_INTEGER].size + pools[NUMTAB_REAL].size;
+    return pools[NUMTAB_INTEGER].count + pools[NUMTAB_REAL].count;
 }
 
 /* Frees the number table */
-void freeNumberTable () {
-    free(numTable);
+void freeNumberTable (CompileContext *ctx) {
+    NumberPool *pools = ctx->numtab.pools;
+    for (int k = 0; k < 2; k++) {
+        free(pools[k].values);
+        free(pools[k].index);
+        pools[k] = (NumberPool){.values = NULL, .index = NULL};
+    }
 }
 
 /* Debug Method: Prints state of the table. */
-void printNumberTable() {
-    printf("Size = %u\nHead = %u\nTable = [", numTableSize, np);
-    for (int i = 0; i < np; i++) {
-        printf("%.3f",numTable[i]);
-        if (i < np - 1) {
-            putchar(',');
-        }
+void printNumberTable (CompileContext *ctx) {
+    NumberPool *ints = ctx->numtab.pools + NUMTAB_INTEGER, *reals = ctx->numtab.pools + NUMTAB_REAL;
+
+    printf("Integers = %u of %u\nTable = [", ints->count, ints->size);
+    for (unsigned i = 0; i < ints->count; i++) {
+        printf("%s%lld", (i > 0 ? "," : ""), ints->values[i].i);
+    }
+    printf("]\nReals = %u of %u\nTable = [", reals->count, reals->size);
+    for (unsigned i = 0; i < reals->count; i++) {
+        printf("%s%.3f", (i > 0 ? "," : ""), reals->values[i].r);
     }
     printf("]\n");
 }
@@ -15,9 +15,34 @@
 
 /*
 ********************************************************************************
-*                              Symbolic Constants                              *
+*                              Type Definitions                                *
 ********************************************************************************
-*/  
+*/
+
+/* A constant. Integers and reals are kept in separate pools, each holding
+ * every distinct value once. */
+typedef union {
+    long long i;
+    double r;
+    unsigned long long bits;
+} numType;
+
+// A pool of distinct constants of one kind. Constants are compared by their bit
+// patterns, so integers and reals share one implementation.
+typedef struct {
+    numType *values;        // Constants in order of installation.
+    unsigned count, size;   // Constants installed and allocated.
+    unsigned *index;        // Hash index: Open addressing with linear probing.
+    unsigned indexSize;     // Slots hold position + 1, zero marking empty ones.
+} NumberPool;
+
+// Number table: The integer and the real pool.
+typedef struct {
+    NumberPool pools[2];
+} NumberTable;
+
+// The context of a compilation (see context.h).
+typedef struct compileContext CompileContext;
 
 /*
 ********************************************************************************
@@ -25,20 +50,33 @@
 ********************************************************************************
 */
 
-/* Initializes the number table */
-void initNumberTable ();
+/* Initializes the number table. An existing table is emptied, keeping its allocation */
+void initNumberTable (CompileContext *ctx);
+
+/* Installs given integer constant and returns its value-index. Equal integers share one */
+unsigned installInteger (CompileContext *ctx, long long n);
+
+/* Installs given real constant and returns its value-index. Reals with equal bits share one */
+unsigned installReal (CompileContext *ctx, double n);
+
+/* Returns pointer to the integer at given value-index. NULL if none or not an integer */
+long long *integerAtIndex (CompileContext *ctx, unsigned vi);
+
+/* Returns pointer to the real at given value-index. NULL if none or not a real */
+double *realAtIndex (CompileContext *ctx, unsigned vi);
 
-/* Installs given constant in the table and returns its index */
-unsigned installNumber (double n);
+/* Stores the constant at given value-index in `n`, converting integers to reals.
+ * Returns zero if there is no constant at the index. */
+int numberAtIndex (CompileContext *ctx, unsigned vi, double *n);
 
-/* Returns pointer to constant at given index in the string table. */
-double *numberAtIndex (unsigned vi);
+/* Returns the number of constants in use, storing the allocated count in `size` */
+unsigned numberTableUsage (CompileContext *ctx, unsigned *size);
 
 /* Frees the number table */
-void freeNumberTable ();
+void freeNumberTable (CompileContext *ctx);
 
 /* Debug Method: Prints state of the table. */
-void printNumberTable();
+void printNumberTable (CompileContext *ctx);
 
 
 
@@ -0,0 +1,485 @@
+#include <string.h>
+#include "context.h"
+#include "scanner.h"
+
+/*
+********************************************************************************
+*                    Symbolic Constants & Global Variables                     *
+********************************************************************************
+*/
+
+#define SCANNER_CHUNK_SIZE      65536
+#define SCANNER_DEFAULT_TOKENS  1024
+#define MAX(a,b)                ((a) > (b) ? (a) : (b))
+
+// Vector primitives: 32-byte AVX2 vectors if available, else 16-byte SSE2
+// vectors. Without either, runs are classified a byte at a time.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VECTOR_WIDTH            32
+#define VECTOR_MASK             0xFFFFFFFFu
+typedef __m256i Vector;
+#define vload(p)                _mm256_loadu_si256((const __m256i *)(p))
+#define vsplat(c)               _mm256_set1_epi8(c)
+#define veq(a, b)               _mm256_cmpeq_epi8(a, b)
+#define vgt(a, b)               _mm256_cmpgt_epi8(a, b)
+#define vand(a, b)              _mm256_and_si256(a, b)
+#define vor(a, b)               _mm256_or_si256(a, b)
+#define vmask(v)                ((unsigned)_mm256_movemask_epi8(v))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VECTOR_WIDTH            16
+#define VECTOR_MASK             0xFFFFu
+typedef __m128i Vector;
+#define vload(p)                _mm_loadu_si128((const __m128i *)(p))
+#define vsplat(c)               _mm_set1_epi8(c)
+#define veq(a, b)               _mm_cmpeq_epi8(a, b)
+#define vgt(a, b)               _mm_cmpgt_epi8(a, b)
+#define vand(a, b)              _mm_and_si128(a, b)
+#define vor(a, b)               _mm_or_si128(a, b)
+#define vmask(v)                ((unsigned)_mm_movemask_epi8(v))
+#endif
+
+// Keywords, case-insensitive. Each sits in the slot given by keywordHash,
+// which is collision free over this set. All other slots are empty.
+#define KEYWORD_SLOTS           32
+static const struct {
+    const char *word;
+    unsigned length;
+    unsigned short token;
+} keywords[KEYWORD_SLOTS] = {
+    [0]  = {"var",       3, MP_VAR},
+    [1]  = {"of",        2, MP_OF},
+    [2]  = {"div",       3, MP_DIVOP},
+    [3]  = {"if",        2, MP_IF},
+    [6]  = {"then",      4, MP_THEN},
+    [7]  = {"array",     5, MP_ARRAY},
+    [9]  = {"readln",    6, MP_READLN},
+    [10] = {"integer",   7, MP_TYPE_INTEGER},
+    [11] = {"function",  8, MP_FUNCTION},
+    [12] = {"end",       3, MP_END},
+    [18] = {"begin",     5, MP_BEGIN},
+    [19] = {"while",     5, MP_WHILE},
+    [20] = {"program",   7, MP_PROGRAM},
+    [22] = {"do",        2, MP_DO},
+    [24] = {"writeln",   7, MP_WRITELN},
+    [25] = {"real",      4, MP_TYPE_REAL},
+    [26] = {"procedure", 9, MP_PROCEDURE},
+    [30] = {"else",      4, MP_ELSE},
+    [31] = {"mod",       3, MP_MODOP},
+};
+
+/*
+********************************************************************************
+*                          Internal Scanner Routines                           *
+********************************************************************************
+*/
+
+static inline int isDigit (char c) {
+    return (c >= '0' && c <= '9');
+}
+
+static inline int isLetter (char c) {
+    return ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+static inline int isIdentifierChar (char c) {
+    return (isLetter(c) || isDigit(c) || c == '_');
+}
+
+#if defined(VECTOR_WIDTH)
+
+/* Returns a vector with all bytes of `v` within [lo, hi] set. Bytes above
+ * 0x7F compare as negative, so they are never within an ASCII range. */
+static inline Vector inRange (Vector v, char lo, char hi) {
+    return vand(vgt(v, vsplat(lo - 1)), vgt(vsplat(hi + 1), v));
+}
+
+/* Returns a vector with all identifier characters of `v` set */
+static inline Vector identifierClass (Vector v) {
+    Vector letters = inRange(vor(v, vsplat(0x20)), 'a', 'z');
+    return vor(vor(letters, inRange(v, '0', '9')), veq(v, vsplat('_')));
+}
+
+/* Returns a vector with all whitespace characters of `v` set */
+static inline Vector whitespaceClass (Vector v) {
+    return vor(vor(veq(v, vsplat(' ')), veq(v, vsplat('\t'))), veq(v, vsplat('\n')));
+}
+
+#endif
+
+/* Returns the end of the run of identifier characters at `p` */
+static const char *skipIdentifier (const char *p, const char *end) {
+#if defined(VECTOR_WIDTH)
+    for (; end - p >= VECTOR_WIDTH; p += VECTOR_WIDTH) {
+        unsigned m = ~vmask(identifierClass(vload(p))) & VECTOR_MASK;
+        if (m != 0) {
+            return p + __builtin_ctz(m);
+        }
+    }
+#endif
+    while (p < end && isIdentifierChar(*p)) {
+        p++;
+    }
+    return p;
+}
+
+/* Returns the end of the run of digits at `p` */
+static const char *skipDigits (const char *p, const char *end) {
+#if defined(VECTOR_WIDTH)
+    for (; end - p >= VECTOR_WIDTH; p += VECTOR_WIDTH) {
+        unsigned m = ~vmask(inRange(vload(p), '0', '9')) & VECTOR_MASK;
+        if (m != 0) {
+            return p + __builtin_ctz(m);
+        }
+    }
+#endif
+    while (p < end && isDigit(*p)) {
+        p++;
+    }
+    return p;
+}
+
+/* Returns the end of the run of whitespace at `p`, adding its newlines to `lines` */
+static const char *skipWhitespace (const char *p, const char *end, unsigned *lines) {
+#if defined(VECTOR_WIDTH)
+    for (; end - p >= VECTOR_WIDTH; p += VECTOR_WIDTH) {
+        Vector v = vload(p);
+        unsigned m = ~vmask(whitespaceClass(v)) & VECTOR_MASK;
+        unsigned nl = vmask(veq(v, vsplat('\n')));
+        if (m != 0) {
+            *lines += __builtin_popcount(nl & ((1u << __builtin_ctz(m)) - 1));
+            return p + __builtin_ctz(m);
+        }
+        *lines += __builtin_popcount(nl);
+    }
+#endif
+    for (; p < end && (*p == ' ' || *p == '\t' || *p == '\n'); p++) {
+        *lines += (*p == '\n');
+    }
+    return p;
+}
+
+/* Returns the closing brace of the comment body at `p`, or `end` if there
+ * is none. Newlines before it are added to `lines` */
+static const char *skipComment (const char *p, const char *end, unsigned *lines) {
+#if defined(VECTOR_WIDTH)
+    for (; end - p >= VECTOR_WIDTH; p += VECTOR_WIDTH) {
+        Vector v = vload(p);
+        unsigned m = vmask(veq(v, vsplat('}')));
+        unsigned nl = vmask(veq(v, vsplat('\n')));
+        if (m != 0) {
+            *lines += __builtin_popcount(nl & ((1u << __builtin_ctz(m)) - 1));
+            return p + __builtin_ctz(m);
+        }
+        *lines += __builtin_popcount(nl);
+    }
+#endif
+    for (; p < end && *p != '}'; p++) {
+        *lines += (*p == '\n');
+    }
+    return p;
+}
+
+/* Perfect hash of a keyword candidate of 2 to 9 characters, case-insensitive */
+static inline unsigned keywordHash (const char *s, unsigned n) {
+    unsigned c0 = (unsigned char)s[0] | 0x20, c1 = (unsigned char)s[1] | 0x20;
+    unsigned cn = (unsigned char)s[n - 1] | 0x20;
+    return (5 * c0 + 11 * c1 + 7 * n + cn) & (KEYWORD_SLOTS - 1);
+}
+
+/* Returns the keyword token of the identifier `s` of length `n`, or MP_ID */
+static int keywordToken (const char *s, unsigned n) {
+    unsigned h, i;
+
+    if (n < 2 || n > 9) {
+        return MP_ID;
+    }
+    h = keywordHash(s, n);
+    if (keywords[h].length != n) {
+        return MP_ID;
+    }
+
+    // Only letters fold onto the lowercase letters of a keyword.
+    for (i = 0; i < n; i++) {
+        if ((s[i] | 0x20) != keywords[h].word[i]) {
+            return MP_ID;
+        }
+    }
+    return keywords[h].token;
+}
+
+/* Appends a token to the buffer */
+static void pushToken (TokenBuffer *tb, int kind, size_t offset, size_t length, unsigned line) {
+    if (tb->count == tb->size) {
+        tb->size = MAX(tb->size * 2, SCANNER_DEFAULT_TOKENS);
+        if ((tb->kind = realloc(tb->kind, tb->size * sizeof(unsigned short))) == NULL ||
+            (tb->offset = realloc(tb->offset, tb->size * sizeof(unsigned))) == NULL ||
+            (tb->length = realloc(tb->length, tb->size * sizeof(unsigned))) == NULL ||
+            (tb->line = realloc(tb->line, tb->size * sizeof(unsigned))) == NULL) {
+            fprintf(stderr, "Error: scanner: Couldn't resize token buffer!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    tb->kind[tb->count] = kind;
+    tb->offset[tb->count] = offset;
+    tb->length[tb->count] = length;
+    tb->line[tb->count++] = line;
+}
+
+/* Drops all returned tokens and the source before the end of the last one,
+ * then reads the next chunk of source into the window. Lexemes of dropped
+ * tokens are invalidated, as yytext is by flex. */
+static void refill (Scanner *s) {
+    size_t keep = s->echo, n;
+
+    memmove(s->source, s->source + keep, s->length - keep);
+    s->base += keep;
+    s->length -= keep;
+    s->pos -= keep;
+    s->echo = 0;
+    s->tokens.count = s->next = 0;
+
+    // Keeps a NUL after the window, as after a mapped source.
+    if (s->size - s->length <= SCANNER_CHUNK_SIZE) {
+        s->size = MAX(s->size * 2, s->length + SCANNER_CHUNK_SIZE + 1);
+        if ((s->source = realloc(s->source, s->size)) == NULL) {
+            fprintf(stderr, "Error: scanner: Couldn't resize source window!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if ((n = readSourceChunk(s->ctx, s->in, s->source + s->length, s->size - s->length - 1)) == 0) {
+        s->eof = 1;
+    }
+    s->length += n;
+    s->source[s->length] = '\0';
+}
+
+/* Scans the window from `pos` up to `limit` into the token buffer. Before the
+ * end of input, a token that may continue past `limit` is left for the next
+ * chunk. */
+static void scanTokens (Scanner *s, size_t limit) {
+    const char *base = s->source, *p = base + s->pos, *end = base + limit, *q;
+    unsigned line = s->line, newlines, n;
+    int more = (!s->eof || limit < s->length), kind;
+
+    // Stops at the start of a token which may be incomplete.
+#define PENDING(x)  if ((x) == end && more) goto pending
+
+    while (p < end) {
+        switch (*p) {
+            case ' ': case '\t': case '\n':
+                p = skipWhitespace(p, end, &line);
+                continue;
+            case '{':
+                newlines = 0;
+                q = skipComment(p + 1, end, &newlines);
+                PENDING(q);
+                if (q == end) {
+                    pushToken(&s->tokens, MP_WTF, p - base, 1, line);
+                    p++;
+                } else {
+                    line += newlines;
+                    p = q + 1;
+                }
+                continue;
+            case ':':
+                PENDING(p + 1);
+                kind = (p + 1 < end && p[1] == '=' ? MP_ASSIGNOP : MP_COLON);
+                break;
+            case '<':
+                PENDING(p + 1);
+                kind = (p + 1 < end && p[1] == '=' ? MP_RELOP_LE : 
+                        p + 1 < end && p[1] == '>' ? MP_RELOP_NE : MP_RELOP_LT);
+                break;
+            case '>':
+                PENDING(p + 1);
+                kind = (p + 1 < end && p[1] == '=' ? MP_RELOP_GE : MP_RELOP_GT);
+                break;
+            case '.':
+                PENDING(p + 1);
+                kind = (p + 1 < end && p[1] == '.' ? MP_ELLIPSES : MP_FSTOP);
+                break;
+            case '=': kind = MP_RELOP_EQ;   break;
+            case '+': kind = MP_ADDOP;      break;
+            case '-': kind = MP_SUBOP;      break;
+            case '*': kind = MP_MULOP;      break;
+            case '/': kind = MP_DIVOP;      break;
+            case ',': kind = MP_COMMA;      break;
+            case '(': kind = MP_POPEN;      break;
+            case ')': kind = MP_PCLOSE;     break;
+            case '[': kind = MP_BOPEN;      break;
+            case ']': kind = MP_BCLOSE;     break;
+            case ';': kind = MP_SCOLON;     break;
+            default:
+                if (isLetter(*p)) {
+                    q = skipIdentifier(p + 1, end);
+                    PENDING(q);
+                    pushToken(&s->tokens, keywordToken(p, q - p), p - base, q - p, line);
+                    p = q;
+                    continue;
+                }
+                if (isDigit(*p)) {
+
+                    // An integer, or a real if a fraction follows the point.
+                    q = skipDigits(p + 1, end);
+                    PENDING(q);
+                    kind = MP_INTEGER;
+                    if (q < end && *q == '.') {
+                        PENDING(q + 1);
+                        if (q + 1 < end && isDigit(q[1])) {
+                            q = skipDigits(q + 2, end);
+                            PENDING(q);
+                            kind = MP_REAL;
+                        }
+                    }
+                    pushToken(&s->tokens, kind, p - base, q - p, line);
+                    p = q;
+                    continue;
+                }
+                kind = MP_WTF;
+                break;
+        }
+
+        // Operators and punctuation: Two characters if paired, else one.
+        n = 1 + (kind == MP_ASSIGNOP || kind == MP_RELOP_LE || kind == MP_RELOP_NE ||
+                 kind == MP_RELOP_GE || kind == MP_ELLIPSES);
+        pushToken(&s->tokens, kind, p - base, n, line);
+        p += n;
+    }
+pending:
+#undef PENDING
+
+    s->pos = p - base;
+    s->line = line;
+}
+
+/* Returns the next token from the buffer, scanning the next chunk if empty.
+ * The lexeme is left in the source, where it stays until the next chunk. */
+static int scanToken (Scanner *s) {
+    DebugState *d = &s->ctx->debug;
+    TokenBuffer *tb = &s->tokens;
+    size_t chunk;
+    unsigned i;
+
+    while (s->next == tb->count) {
+        if (s->eof && s->pos == s->length) {
+            s->text = "";
+            s->leng = 0;
+            s->lineno = s->line;
+            d->offset = s->base + s->length;
+            d->line = s->lineno;
+            echoSource(s->ctx, d->offset, 1);
+            return MP_EOF;
+        }
+        if (!s->eof) {
+            refill(s);
+            scanTokens(s, s->length);
+            continue;
+        }
+
+        // A source in memory is scanned a chunk at a time, reusing the buffer.
+        // Chunks grow while a token spans them.
+        chunk = SCANNER_CHUNK_SIZE;
+        do {
+            tb->count = s->next = 0;
+            scanTokens(s, (s->length - s->pos > chunk ? s->pos + chunk : s->length));
+            chunk *= 2;
+        } while (tb->count == 0 && s->pos < s->length);
+    }
+
+    // Only the end of the token is noted for diagnostics (see debug.h).
+    i = s->next++;
+    s->text = s->source + tb->offset[i];
+    s->leng = tb->length[i];
+    s->lineno = tb->line[i];
+    s->echo = tb->offset[i] + tb->length[i];
+    d->offset = s->base + s->echo;
+    d->line = s->lineno;
+    if (s->ctx->options.debug) {
+        echoSource(s->ctx, s->base + tb->offset[i], 0);
+    }
+    if (tb->kind[i] == MP_WTF) {
+        printBadToken(s->ctx, s->text, s->leng);
+    }
+    return tb->kind[i];
+}
+
+/*
+********************************************************************************
+*                               Scanner Routines                               *
+********************************************************************************
+*/
+
+/* Allocates a scanner for compilation `ctx`. Returns nonzero on error */
+int yylex_init_extra (CompileContext *ctx, yyscan_t *scanner) {
+    Scanner *s;
+
+    if ((s = calloc(1, sizeof(Scanner))) == NULL) {
+        return 1;
+    }
+    s->ctx = ctx;
+    s->line = s->lineno = 1;
+    s->in = stdin;
+    *scanner = s;
+    return 0;
+}
+
+/* Sets the source stream of the scanner */
+void yyset_in (FILE *fp, yyscan_t scanner) {
+    ((Scanner *)scanner)->in = fp;
+}
+
+/* Scans the `length` bytes at `source` in place of the source stream. The
+ * byte after them must be NUL. Lexemes are spans of the source, which must
+ * outlive the scanner. */
+void setScannerSource (const char *source, size_t length, yyscan_t scanner) {
+    Scanner *s = scanner;
+    s->source = (char *)source;
+    s->length = length;
+    s->mapped = s->eof = 1;
+}
+
+/* Returns the compilation of the scanner */
+CompileContext *yyget_extra (yyscan_t scanner) {
+    return ((Scanner *)scanner)->ctx;
+}
+
+/* Returns the lexeme of the last token. It is not terminated (see yyget_leng) */
+char *yyget_text (yyscan_t scanner) {
+    return (char *)((Scanner *)scanner)->text;
+}
+
+/* Returns the length of the lexeme of the last token */
+int yyget_leng (yyscan_t scanner) {
+    return ((Scanner *)scanner)->leng;
+}
+
+/* Returns the line of the last token */
+int yyget_lineno (yyscan_t scanner) {
+    return ((Scanner *)scanner)->lineno;
+}
+
+/* Returns the next token. Time spent scanning is charged to the lexing phase */
+int yylex (YYSTYPE *lvalp, yyscan_t scanner) {
+    CompileContext *ctx = yyget_extra(scanner);
+    Phase prev = enterPhase(ctx, PHASE_LEX);
+    int token = scanToken(scanner);
+    enterPhase(ctx, prev);
+    return token;
+}
+
+/* Frees the scanner. Returns zero */
+int yylex_destroy (yyscan_t scanner) {
+    Scanner *s = scanner;
+
+    if (!s->mapped) {
+        free(s->source);
+    }
+    free(s->tokens.kind);
+    free(s->tokens.offset);
+    free(s->tokens.length);
+    free(s->tokens.line);
+    free(s);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#if !defined(SCANNER_H)
+#define SCANNER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mpascal.tab.h"
+
+/*
+    ***************************************************************************
+    *                      Mini Pascal Vector Scanner                         *
+    * AUTHORS: Charles Randolph, Joe Jones.                                   *
+    * SNUMBERS: s2897318, s2990652.                                           *
+    ***************************************************************************
+*/
+
+/*
+ * A hand-written alternative to the flex scanner (mpascal.lex), selected with
+ * `make SCANNER=simd`. The source is read in large chunks and each chunk is
+ * scanned at once into a token buffer, classifying runs of identifier
+ * characters, digits, whitespace and comments 16 (SSE2) or 32 (AVX2) bytes
+ * at a time. Keywords are recognized with a perfect hash. The parser then
+ * takes the tokens from the buffer one at a time, through the same reentrant
+ * interface as flex (yylex, yyget_text, ...), so both scanners are
+ * interchangeable. Flex remains the reference implementation.
+ *
+ * Lexemes are never copied: yyget_text points into the source, which may be
+ * a memory-mapped file (see setScannerSource), and yyget_leng gives the
+ * length. The byte after the source is always NUL.
+ */
+
+/*
+********************************************************************************
+*                               Type Definitions                               *
+********************************************************************************
+*/
+
+// Token buffer: The tokens of a chunk as a structure of arrays.
+typedef struct {
+    unsigned short *kind;       // Token (MP_<token>).
+    unsigned *offset;           // Offset of the lexeme in the source window.
+    unsigned *length;           // Length of the lexeme.
+    unsigned *line;             // Line of the lexeme.
+    unsigned count, size;       // Tokens in the buffer, and its allocated size.
+} TokenBuffer;
+
+// Scanner state. The source window holds the text from the end of the last
+// token returned up to the end of input read so far, or all of a source
+// given in memory.
+typedef struct {
+    CompileContext *ctx;        // Compilation (extra data, as in flex).
+    FILE *in;                   // Source stream.
+    char *source;               // Source window (or the source, if mapped).
+    size_t base;                // Offset of the window in the source.
+    size_t length, size;        // Bytes in the window, and its allocated size.
+    size_t pos;                 // Offset at which scanning resumes.
+    unsigned line;              // Line at `pos`.
+    int eof;                    // Set once the end of input is read.
+    int mapped;                 // Set if the source is given in memory.
+    TokenBuffer tokens;         // Tokens scanned from the window.
+    unsigned next;              // Next token to return.
+    size_t echo;                // End of the last token returned.
+    const char *text;           // Lexeme of the last token returned.
+    unsigned leng;              // Length of the lexeme.
+    unsigned lineno;            // Line of the last token returned.
+} Scanner;
+
+/*
+********************************************************************************
+*                               Scanner Routines                               *
+********************************************************************************
+*/
+
+/* Allocates a scanner for compilation `ctx`. Returns nonzero on error */
+int yylex_init_extra (CompileContext *ctx, yyscan_t *scanner);
+
+/* Sets the source stream of the scanner */
+void yyset_in (FILE *fp, yyscan_t scanner);
+
+/* Scans the `length` bytes at `source` in place of the source stream. The
+ * byte after them must be NUL. Lexemes are spans of the source, which must
+ * outlive the scanner */
+void setScannerSource (const char *source, size_t length, yyscan_t scanner);
+
+/* Returns the compilation of the scanner */
+CompileContext *yyget_extra (yyscan_t scanner);
+
+/* Returns the lexeme of the last token. It is not terminated (see yyget_leng) */
+char *yyget_text (yyscan_t scanner);
+
+/* Returns the length of the lexeme of the last token */
+int yyget_leng (yyscan_t scanner);
+
+/* Returns the line of the last token */
+int yyget_lineno (yyscan_t scanner);
+
+/* Returns the next token. Time spent scanning is charged to the lexing phase */
+int yylex (YYSTYPE *lvalp, yyscan_t scanner);
+
+/* Frees the scanner. Returns zero */
+int yylex_destroy (yyscan_t scanner);
+
+#endif
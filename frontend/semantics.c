@@ -1,3 +1,5 @@
+#include <math.h>
+#include <limits.h>
 #include "semantics.h"
 
 #define MAX(a,b)        ((a) > (b) ? (a) : (b))
@@ -8,8 +10,32 @@
 ********************************************************************************
 */
 
-/* Performs an operation based on the given lexer token */
-static double performOperation (unsigned operator, double a, double b) {
+/* Performs an operation on integers based on the given lexer token. Stores the
+ * result in `r`. Returns zero if it overflows 64 bits. The divisor is nonzero. */
+static int performIntegerOperation (unsigned operator, long long a, long long b, long long *r) {
+    switch (operator) {
+
+        // Arithmetic Operators. Division truncates, as in the generated C.
+        case MP_ADDOP: return !__builtin_add_overflow(a, b, r);
+        case MP_SUBOP: return !__builtin_sub_overflow(a, b, r);
+        case MP_MULOP: return !__builtin_mul_overflow(a, b, r);
+        case MP_DIVOP: return (b != -1 || a != LLONG_MIN) && (*r = a / b, 1);
+        case MP_MODOP: return (*r = (b == -1 ? 0 : a % b), 1);
+
+        // Boolean Operators.
+        case MP_RELOP_LT: return (*r = (a < b), 1);
+        case MP_RELOP_LE: return (*r = (a <= b), 1);
+        case MP_RELOP_EQ: return (*r = (a == b), 1);
+        case MP_RELOP_GE: return (*r = (a >= b), 1);
+        case MP_RELOP_GT: return (*r = (a > b), 1);
+        case MP_RELOP_NE: return (*r = (a != b), 1);
+    }
+    fprintf(stderr, "Error: performIntegerOperation: Unknown operator %d\n", operator);
+    exit(EXIT_FAILURE);
+}
+
+/* Performs an operation on reals based on the given lexer token */
+static double performRealOperation (unsigned operator, double a, double b) {
     switch (operator) {
 
         // Arithmetic Operators.
@@ -17,7 +43,7 @@ static double performOperation (unsigned operator, double a, double b) {
         case MP_SUBOP: return a - b;
         case MP_DIVOP: return a / b;
         case MP_MULOP: return a * b;
-        case MP_MODOP: return (double)((int)a % (int)b);
+        case MP_MODOP: return fmod(a, b);
 
         // Boolean Operators.
         case MP_RELOP_LT: return (a < b);
@@ -27,10 +53,59 @@ static double performOperation (unsigned operator, double a, double b) {
         case MP_RELOP_GT: return (a > b);
         case MP_RELOP_NE: return (a != b);
     }
-    fprintf(stderr, "Error: performOperation: Unknown operator %d\n", operator);
+    fprintf(stderr, "Error: performRealOperation: Unknown operator %d\n", operator);
     exit(EXIT_FAILURE);
 }
 
+/*
+********************************************************************************
+*                             Constant Functions                               *
+********************************************************************************
+*/
+
+/* Folds an operation between the constants at value-indices `avi` and `bvi`.
+ * 1. Integer operands are folded exactly. Overflowing results are not folded.
+ * 2. Otherwise operands are promoted to reals. Comparisons result in integers.
+ * Returns the value-index of the result, or NIL if it can't be folded. */
+unsigned foldOperation (CompileContext *ctx, unsigned operator, unsigned avi, unsigned bvi) {
+    long long *ai, *bi, r;
+    double a, b;
+
+    // (1). Fold integers exactly.
+    if ((ai = integerAtIndex(ctx, avi)) != NULL && (bi = integerAtIndex(ctx, bvi)) != NULL) {
+        return performIntegerOperation(operator, *ai, *bi, &r) ? installInteger(ctx, r) : NIL;
+    }
+
+    // (2). Fold reals.
+    if (!numberAtIndex(ctx, avi, &a) || !numberAtIndex(ctx, bvi, &b)) {
+        return NIL;
+    }
+    if (operator >= MP_RELOP_LT && operator <= MP_RELOP_NE) {
+        return installInteger(ctx, (long long)performRealOperation(operator, a, b));
+    }
+    return installReal(ctx, performRealOperation(operator, a, b));
+}
+
+/* Installs the integer literal of `n` digits at `text`. Returns its value-index.
+ * Literals must fit the C int they are generated as: Larger ones are an error,
+ * and have no constant value (NIL). */
+unsigned installIntegerLiteral (CompileContext *ctx, const char *text, unsigned n) {
+    long long value = strtoll(text, NULL, 10);
+    char digits[32];
+
+    // The lexeme need not be terminated, and very long ones are cut short.
+    if (value > INT_MAX) {
+        if (n < sizeof(digits)) {
+            snprintf(digits, sizeof(digits), "%.*s", (int)n, text);
+        } else {
+            snprintf(digits, sizeof(digits), "%.*s...", (int)sizeof(digits) - 4, text);
+        }
+        printError(ctx, "Integer constant %s is out of range (at most %d)!", digits, INT_MAX);
+        return NIL;
+    }
+    return installInteger(ctx, value);
+}
+
 /*
 ********************************************************************************
 *                             Identifier Functions                             *
@@ -38,12 +113,12 @@ static double performOperation (unsigned operator, double a, double b) {
 */
 
 /* Returns zero and throws error if id of type-class tc isn't in symbol table. */
-unsigned existsId (unsigned id, unsigned tc) {
+unsigned existsId (CompileContext *ctx, unsigned id, unsigned tc) {
     IdEntry *entry;
 
-    if ((entry = containsIdEntry(id, tc, SYMTAB_SCOPE_ALL)) == NULL) {
-        printError("Expected identifier \"%s\" of class \"%s\", but none exists!",
-            identifierAtIndex(id),
+    if ((entry = containsIdEntry(ctx, id, tc, SYMTAB_SCOPE_ALL)) == NULL) {
+        printError(ctx, "Expected identifier \"%s\" of class \"%s\", but none exists!",
+            identifierAtIndex(ctx, id),
             tokenClassName(tc));
         return 0;
     }
@@ -54,18 +129,18 @@ unsigned existsId (unsigned id, unsigned tc) {
   * Only checks current table scope. If id doesn't exist in scope, no warning
   * is displayed.
 */ 
-void isInitialized (unsigned id, unsigned tc) {
+void isInitialized (CompileContext *ctx, unsigned id, unsigned tc) {
     IdEntry *entry;
-    if ((entry = containsIdEntry(id, tc, currentTableScope())) != NULL && entry->rf == 0) {
-        printWarning("\"%s\" of class \"%s\" exists but is uninitialized!", 
-            identifierAtIndex(entry->id),
+    if ((entry = containsIdEntry(ctx, id, tc, currentTableScope(ctx))) != NULL && entry->rf == 0) {
+        printWarning(ctx, "\"%s\" of class \"%s\" exists but is uninitialized!", 
+            identifierAtIndex(ctx, entry->id),
             tokenClassName(entry->tc));
     }
 }
 
 /* Returns the token-type for an identifier. Must exist in symbol table. */
-unsigned getIdTokenType (unsigned id, unsigned tc) {
-    IdEntry *entry = containsIdEntry(id, tc, SYMTAB_SCOPE_ALL);
+unsigned getIdTokenType (CompileContext *ctx, unsigned id, unsigned tc) {
+    IdEntry *entry = containsIdEntry(ctx, id, tc, SYMTAB_SCOPE_ALL);
     return entry->tt;
 }
 
@@ -76,13 +151,13 @@ unsigned getIdTokenType (unsigned id, unsigned tc) {
 */
 
 /* Throws error if expression-variable type isn't of given token-class and token-type */
-void requireExprVarType (unsigned tc, unsigned tt, varType var) {
+void requireExprVarType (CompileContext *ctx, unsigned tc, unsigned tt, varType var) {
     if (var.tc != tc) {
-        printError("Expected class \"%s\" but got class \"%s\" instead!",
+        printError(ctx, "Expected class \"%s\" but got class \"%s\" instead!",
             tokenClassName(tc), tokenClassName(var.tc));
     }
     if (var.tt != tt) {
-        printError("Expected type \"%s\" but got type \"%s\" instead!",
+        printError(ctx, "Expected type \"%s\" but got type \"%s\" instead!",
             tokenTypeName(tt), tokenTypeName(var.tt));
     }
 }
@@ -91,36 +166,31 @@ void requireExprVarType (unsigned tc, unsigned tt, varType var) {
  * 1. If operator involves division, throw div-zero-error if 'b' is zero.
  * 2. If any operand has no constant value, then result is just the token-type.
  * Results are type-promoted to reals if operands mismatch.  */ 
-varType resolveArithmeticOperation (unsigned operator, varType a, varType b) {
-    double *vp;
+varType resolveArithmeticOperation (CompileContext *ctx, unsigned operator, varType a, varType b) {
+    double divisor;
 
     // (*). Verify operands have correct token-class.
     if (a.tc != TC_SCALAR || b.tc != TC_SCALAR) {
-        printError("Arithmetic operation is undefined for non-scalar operands!");
+        printError(ctx, "Arithmetic operation is undefined for non-scalar operands!");
         return initExprVarType(UNDEFINED, UNDEFINED, NIL);
     }
 
     // (*). Verify operands have correct token-type.
     if (a.tt == UNDEFINED || b.tt == UNDEFINED) {
-        printError("Arithmetic operation is undefined for operands of type: \"%s\"!\n", 
+        printError(ctx, "Arithmetic operation is undefined for operands of type: \"%s\"!\n", 
         tokenTypeName(UNDEFINED));
         return initExprVarType(TC_SCALAR, UNDEFINED, NIL);
     }
 
     // (1). Check for division by zero. 
     if ((operator == MP_DIVOP || operator == MP_MODOP) && 
-        (vp = numberAtIndex(b.vi)) != NULL && (*vp == 0.0)) {
-        printError("Division by zero!");
+        numberAtIndex(ctx, b.vi, &divisor) && divisor == 0.0) {
+        printError(ctx, "Division by zero!");
         return initExprVarType(TC_SCALAR, UNDEFINED, NIL);
     }
 
     // (2). Determine resulting constant value.
-    double *avp, *bvp, newValueIndex;
-    if ((avp = numberAtIndex(a.vi)) == NULL || (bvp = numberAtIndex(b.vi)) == NULL) {
-        newValueIndex = NIL;
-    } else {
-        newValueIndex = installNumber(performOperation(operator, *avp, *bvp));
-    }
+    unsigned newValueIndex = foldOperation(ctx, operator, a.vi, b.vi);
 
     // (*). Return new exprVarType. Type promote resulting type if mismatched.
     return initExprVarType(TC_SCALAR, MAX(a.tt, b.tt), newValueIndex);
@@ -131,28 +201,23 @@ varType resolveArithmeticOperation (unsigned operator, varType a, varType b) {
  * 2. If any operand has no constant value, then result is just type MP_INTEGER.
  * Results of comparisons are always MP_INTEGER where defined.
 */
-varType resolveBooleanOperation (unsigned operator, varType a, varType b) {
+varType resolveBooleanOperation (CompileContext *ctx, unsigned operator, varType a, varType b) {
 
     // (*). Verify operands have correct token-class.
     if (a.tc != TC_SCALAR || b.tc != TC_SCALAR) {
-        printError("Boolean operation is undefined for non-scalar operands!");
+        printError(ctx, "Boolean operation is undefined for non-scalar operands!");
         return initExprVarType(UNDEFINED, UNDEFINED, NIL);
     }
 
     // (*). Verify operands have correct token-type.
     if (a.tt == UNDEFINED || b.tt == UNDEFINED) {
-        printError("Boolean operation is undefined for operands of type: \"%s\"!\n", 
+        printError(ctx, "Boolean operation is undefined for operands of type: \"%s\"!\n", 
         tokenTypeName(UNDEFINED));
         return initExprVarType(TC_SCALAR, UNDEFINED, NIL);
     }
 
     // (2). Determine resulting constant value.
-    double *avp, *bvp, newValueIndex;
-    if ((avp = numberAtIndex(a.vi)) == NULL || (bvp = numberAtIndex(b.vi)) == NULL) {
-        newValueIndex = NIL;
-    } else {
-        newValueIndex = installNumber(performOperation(operator, *avp, *bvp));
-    }
+    unsigned newValueIndex = foldOperation(ctx, operator, a.vi, b.vi);
 
     // (*). Return new exprVarType.
     return initExprVarType(TC_SCALAR, TT_INTEGER, newValueIndex);
@@ -161,7 +226,7 @@ varType resolveBooleanOperation (unsigned operator, varType a, varType b) {
 /* Applies a sign to a constant exprVarType. If not constant, the exprVarType
  * is simply returned.
 */
-varType applySign (unsigned operator, varType exprVarType) {
+varType applySign (CompileContext *ctx, unsigned operator, varType exprVarType) {
 
     // (*). Return exprVarType if not scalar (shouldn't have set value anyways if so)
     //      Also return if it is a scalar but has no constant value.
@@ -169,22 +234,31 @@ varType applySign (unsigned operator, varType exprVarType) {
         return exprVarType;
     }
 
-    // (*). Install new constant value in symbol table. Re-assign value-index.
-    int sign = (operator == MP_ADDOP) ? 1 : -1;
-    double *vp = numberAtIndex(exprVarType.vi); 
-    return initExprVarType(TC_SCALAR, exprVarType.tt, installNumber(sign * *vp));
+    // (*). Install new constant value in number table. Re-assign value-index.
+    //      Negating the least integer overflows, so it is left unfolded.
+    long long *ip = integerAtIndex(ctx, exprVarType.vi);
+    double *rp = realAtIndex(ctx, exprVarType.vi);
+    unsigned vi = NIL;
+    if (operator == MP_ADDOP) {
+        vi = exprVarType.vi;
+    } else if (ip != NULL && *ip != LLONG_MIN) {
+        vi = installInteger(ctx, -*ip);
+    } else if (rp != NULL) {
+        vi = installReal(ctx, -*rp);
+    }
+    return initExprVarType(TC_SCALAR, exprVarType.tt, vi);
 }
 
 /* Throws a warning if token-type of variable-expression isn't integer */
-void verifyGuardExprVar (varType var) {
+void verifyGuardExprVar (CompileContext *ctx, varType var) {
     if (var.tc != TC_SCALAR || var.tt == UNDEFINED) {
-        printError("Guard expression must a \"%s\" of type \"%s\". Got \"%s\" of type \"%s\"!",
+        printError(ctx, "Guard expression must a \"%s\" of type \"%s\". Got \"%s\" of type \"%s\"!",
             tokenClassName(TC_SCALAR), tokenTypeName(TT_INTEGER), tokenClassName(var.tc),
             tokenTypeName(var.tt));
         return;
     }
     if (var.tt != TT_INTEGER) {
-        printWarning("Guard expression will be truncated!");
+        printWarning(ctx, "Guard expression will be truncated!");
     }
 }
 
@@ -197,12 +271,12 @@ void verifyGuardExprVar (varType var) {
 /* Extracts an IdEntry from the symbol table and initializes a varType instance.
  * Requires the IdEntry to already exist.
 */
-varType initVarTypeFromId (unsigned id, unsigned tc) {
+varType initVarTypeFromId (CompileContext *ctx, unsigned id, unsigned tc) {
     IdEntry *entry;
 
     // (*). Extract IdEntry, verify exists.
-    if ((entry = containsIdEntry(id, tc, SYMTAB_SCOPE_ALL)) == NULL) {
-        fprintf(stderr, "Error: initVarTypeFromId: Null entry for \"%s\"!\n", identifierAtIndex(id));
+    if ((entry = containsIdEntry(ctx, id, tc, SYMTAB_SCOPE_ALL)) == NULL) {
+        fprintf(stderr, "Error: initVarTypeFromId: Null entry for \"%s\"!\n", identifierAtIndex(ctx, id));
         exit(EXIT_FAILURE);
     }
 
@@ -216,36 +290,36 @@ varType initVarTypeFromId (unsigned id, unsigned tc) {
  * 4. Type promotion or truncation occurs in case of mismatching primitives.
  * 5. Sets the reference flag (rf) to true.
  */ 
-void verifyAssignment (varType var, varType exprVar) {
+void verifyAssignment (CompileContext *ctx, varType var, varType exprVar) {
     IdEntry *entry;
 
     // (1). Verify variable token-class is assignable.
     if (var.tc != TC_SCALAR && var.tc != TC_VECTOR) {
-        printError("\"%s\" of class \"%s\" is not assignable!",
-        identifierAtIndex(var.id), tokenClassName(var.tc));
+        printError(ctx, "\"%s\" of class \"%s\" is not assignable!",
+        identifierAtIndex(ctx, var.id), tokenClassName(var.tc));
         return;
     }
 
     // (2). Verify that expression-variable token-type is primitive.
     if (exprVar.tt == UNDEFINED) {
-        printError("\"%s\" may not be assigned to \"%s\" \"%s\"!", 
+        printError(ctx, "\"%s\" may not be assigned to \"%s\" \"%s\"!", 
         tokenTypeName(exprVar.tt), tokenClassName(var.tc), tokenTypeName(var.tt));
         return;
     }
 
     // (3). If expression-variable has an id. Verify that variable was initialized.
     if (exprVar.id != NIL) {
-        isInitialized(exprVar.id, exprVar.tc);
+        isInitialized(ctx, exprVar.id, exprVar.tc);
     } 
 
     // (*). Extract IdEntry of id in var (Expects IdEntry to exist).
-    entry = containsIdEntry(var.id, var.tc, SYMTAB_SCOPE_ALL);
+    entry = containsIdEntry(ctx, var.id, var.tc, SYMTAB_SCOPE_ALL);
 
     // (4). Verify exprVarType token-type matches.
     if (entry->tt < exprVar.tt) {
-        printWarning("Value assigned to \"%s\" \"%s\" will be truncated!",
+        printWarning(ctx, "Value assigned to \"%s\" \"%s\" will be truncated!",
             tokenTypeName(entry->tt),
-            identifierAtIndex(var.id)
+            identifierAtIndex(ctx, var.id)
         );
     }
 
@@ -258,6 +332,8 @@ varListType mapDescToVarList (descType desc, varListType varList) {
     for (int i = 0; i < varList.length; i++) {
         varList.list[i].tc = desc.tc;
         varList.list[i].tt = desc.tt;
+        varList.list[i].vb = desc.vb;
+        varList.list[i].vl = desc.vl;
     }
     return varList;
 }
@@ -265,16 +341,18 @@ varListType mapDescToVarList (descType desc, varListType varList) {
 /* Installs a list of varTypes into the symbol table. 
  * 1. Verifies no variable already exists in current scope
  */
-void installVarList (varListType varList) {
+void installVarList (CompileContext *ctx, varListType varList) {
     IdEntry *entry;
 
     for (int i = 0; i < varList.length; i++) {
         varType var = varList.list[i];
-        if ((entry = containsIdEntry(var.id, var.tc, currentTableScope())) != NULL) {
-            printError("Redeclaration of \"%s\" \"%s\" in current scope!",
-                tokenClassName(var.tc), identifierAtIndex(var.id));
+        if ((entry = containsIdEntry(ctx, var.id, var.tc, currentTableScope(ctx))) != NULL) {
+            printError(ctx, "Redeclaration of \"%s\" \"%s\" in current scope!",
+                tokenClassName(var.tc), identifierAtIndex(ctx, var.id));
         } else {
-            installIdEntry(var.id, var.tc, var.tt);
+            entry = installIdEntry(ctx, var.id, var.tc, var.tt);
+            entry->vb = var.vb;
+            entry->vl = var.vl;
         }
     }
 }
@@ -290,40 +368,40 @@ void installVarList (varListType varList) {
  * Procedures are identifier with an UNDEFINED token-type.
  * Returns nonzero if successful.
 */
-unsigned installRoutine (unsigned id, unsigned tt) {
+unsigned installRoutine (CompileContext *ctx, unsigned id, unsigned tt) {
     IdEntry *entry;
 
     // (1). Verify id is unused.
-    if ((entry = containsIdEntry(id, TC_ROUTINE, SYMTAB_SCOPE_ALL)) != NULL) {
-        printError("Illegal redefinition of \"%s\" \"%s\"!",
-            tokenClassName(entry->tc), identifierAtIndex(id));
+    if ((entry = containsIdEntry(ctx, id, TC_ROUTINE, SYMTAB_SCOPE_ALL)) != NULL) {
+        printError(ctx, "Illegal redefinition of \"%s\" \"%s\"!",
+            tokenClassName(entry->tc), identifierAtIndex(ctx, id));
         return 0;
     }
 
     // (*). Install routine in symbol table.
-    installIdEntry(id, TC_ROUTINE, tt);
+    installIdEntry(ctx, id, TC_ROUTINE, tt);
 
     return 1;
 }
 
 /* Installs all routine arguments in the symbol table under 'id'. */
-void installRoutineArgs (unsigned id, varListType varList) {
+void installRoutineArgs (CompileContext *ctx, unsigned id, varListType varList) {
     IdEntry *arg, **argv;
 
     // (*). Extract IdEntry.
-    IdEntry *entry = containsIdEntry(id, TC_ROUTINE, SYMTAB_SCOPE_ALL);
+    IdEntry *entry = containsIdEntry(ctx, id, TC_ROUTINE, SYMTAB_SCOPE_ALL);
 
     // (*). Install new local scalar with routine token-type if function.
     if (entry->tt != UNDEFINED) {
-        installIdEntry(id, TC_SCALAR, entry->tt);
+        installIdEntry(ctx, id, TC_SCALAR, entry->tt);
     }
 
     // (*). Verify argument-list token-class is scalar or vector.
     for (int i = 0; i < varList.length; i++) {
         varType var = varList.list[i];
         if (var.tc != TC_SCALAR && var.tc != TC_VECTOR) {
-            printError("Parameter \"%s\" in routine \"%s\" has illegal type-class \"%s\"!",
-            identifierAtIndex(var.id), identifierAtIndex(id), tokenClassName(var.tc));
+            printError(ctx, "Parameter \"%s\" in routine \"%s\" has illegal type-class \"%s\"!",
+            identifierAtIndex(ctx, var.id), identifierAtIndex(ctx, id), tokenClassName(var.tc));
             return;
         }
     }
@@ -337,17 +415,18 @@ void installRoutineArgs (unsigned id, varListType varList) {
     // (*). Install arguments (should be no existing entries).
     for (int i = 0; i < varList.length; i++) {
         varType var = varList.list[i];
-        if (containsIdEntry(var.id, var.tc, currentTableScope())) {
-            printError("Duplicate parameters (\"%s\" \"%s\") in function \"%s\"!",
-            tokenClassName(var.tc), identifierAtIndex(var.id), identifierAtIndex(id));
+        if (containsIdEntry(ctx, var.id, var.tc, currentTableScope(ctx))) {
+            printError(ctx, "Duplicate parameters (\"%s\" \"%s\") in function \"%s\"!",
+            tokenClassName(var.tc), identifierAtIndex(ctx, var.id), identifierAtIndex(ctx, id));
             return;
         }
-        arg = installIdEntry(var.id, var.tc, var.tt);
+        arg = installIdEntry(ctx, var.id, var.tc, var.tt);
         arg->rf = 1;
         argv[i] = copyIdEntry(arg);
     }
 
-    // (*). Assign argument vector and length to IdEntry entry.
+    // (*). Assign argument vector and length to IdEntry entry. Installing may have moved it.
+    entry = containsIdEntry(ctx, id, TC_ROUTINE, SYMTAB_SCOPE_ALL);
     entry->data.argc = varList.length;
     entry->data.argv = (void **)argv;
 }
@@ -357,19 +436,19 @@ void installRoutineArgs (unsigned id, varListType varList) {
  * 1) Verifies expression-variable list count matches argument count.
  * 2) Verifies expression-variable token-types match argument token-types.
 */
-void verifyRoutineArgs (unsigned id, varListType exprVarList) {
+void verifyRoutineArgs (CompileContext *ctx, unsigned id, varListType exprVarList) {
     IdEntry *entry;
 
     // (*). Extract IdEntry, verify exists.
-    if ((entry = containsIdEntry(id, TC_ROUTINE, SYMTAB_SCOPE_ALL)) == NULL) {
+    if ((entry = containsIdEntry(ctx, id, TC_ROUTINE, SYMTAB_SCOPE_ALL)) == NULL) {
         fprintf(stderr, "Error: verifyRoutineArgs: Null entry!\n");
         exit(EXIT_FAILURE);
     }
 
     // (1). Verify length matches.
     if (entry->data.argc != exprVarList.length) {
-        printError("\"%s\" requires %d argument%s, not %d!", 
-        identifierAtIndex(id), entry->data.argc, (entry->data.argc > 1) ? "s" : "", 
+        printError(ctx, "\"%s\" requires %d argument%s, not %d!", 
+        identifierAtIndex(ctx, id), entry->data.argc, (entry->data.argc > 1) ? "s" : "", 
         exprVarList.length);
         return;
     }
@@ -380,14 +459,14 @@ void verifyRoutineArgs (unsigned id, varListType exprVarList) {
         varType exprVar = exprVarList.list[i];
 
         if (exprVar.tc != arg->tc) {
-            printError("Parameter %d of routine \"%s\" expects type-class \"%s\" but got \"%s\"!",
-                i + 1, identifierAtIndex(id), tokenClassName(arg->tc), tokenClassName(exprVar.tc));
+            printError(ctx, "Parameter %d of routine \"%s\" expects type-class \"%s\" but got \"%s\"!",
+                i + 1, identifierAtIndex(ctx, id), tokenClassName(arg->tc), tokenClassName(exprVar.tc));
             continue;
         }
 
         if (exprVar.tt > arg->tt) {
-            printWarning("Argument %d of routine \"%s\" will be truncated!\n",
-                i + 1, identifierAtIndex(id));
+            printWarning(ctx, "Argument %d of routine \"%s\" will be truncated!\n",
+                i + 1, identifierAtIndex(ctx, id));
         }
     }
 }
@@ -395,18 +474,18 @@ void verifyRoutineArgs (unsigned id, varListType exprVarList) {
 /* Verifies that a function routine has an initialized return variable.
  * This function must be invoked before dropping the table scope level.
  */
-void verifyFunctionReturnValue (unsigned id) {
+void verifyFunctionReturnValue (CompileContext *ctx, unsigned id) {
     IdEntry *entry;
 
     // (*). Extract entry.
-    if ((entry = containsIdEntry(id, TC_SCALAR, currentTableScope())) == NULL) {
+    if ((entry = containsIdEntry(ctx, id, TC_SCALAR, currentTableScope(ctx))) == NULL) {
         fprintf(stderr, "Error: verifyFunctionReturnValue: Return variable not in function scope!\n");
         exit(EXIT_FAILURE);
     }
 
     // (*). Verify initialization.
     if (entry->rf == 0) {
-        printError("Return value for function \"%s\" is uninitialized!", identifierAtIndex(id));
+        printError(ctx, "Return value for function \"%s\" is uninitialized!", identifierAtIndex(ctx, id));
     }
 }
 
@@ -419,7 +498,7 @@ void verifyFunctionReturnValue (unsigned id) {
 /* Verifies all arguments supplied to readln exist and are variables.
  * Marks all arguments as initialized.
 */ 
-void verifyReadlnArgs (varListType exprVarList) {
+void verifyReadlnArgs (CompileContext *ctx, varListType exprVarList) {
     IdEntry *entry;
     varType var;
 
@@ -427,8 +506,8 @@ void verifyReadlnArgs (varListType exprVarList) {
     for (int i = 0; i < exprVarList.length; i++) {
         var = exprVarList.list[i];
 
-        if (var.id == NIL || (entry = containsIdEntry(var.id, TC_SCALAR, SYMTAB_SCOPE_ALL)) == NULL) {
-            printError("Argument %d does not exist or is not of required class \"%s\" in readln!",
+        if (var.id == NIL || (entry = containsIdEntry(ctx, var.id, TC_SCALAR, SYMTAB_SCOPE_ALL)) == NULL) {
+            printError(ctx, "Argument %d does not exist or is not of required class \"%s\" in readln!",
                 i + 1, tokenClassName(TC_SCALAR));
         } else {
 
@@ -439,7 +518,7 @@ void verifyReadlnArgs (varListType exprVarList) {
 }
 
 /* Verifies all arguments are scalar and initialized if variables. */
-void verifyWritelnArgs (varListType exprVarList) {
+void verifyWritelnArgs (CompileContext *ctx, varListType exprVarList) {
     IdEntry *entry;
     varType var;
 
@@ -448,20 +527,20 @@ void verifyWritelnArgs (varListType exprVarList) {
 
         // Verify that given argument is scalar.
         if (var.tc != TC_SCALAR) {
-            printError("Argument %d in writeln is not of required type-class \"%s\"!",
+            printError(ctx, "Argument %d in writeln is not of required type-class \"%s\"!",
                 i + 1, tokenClassName(var.tc));
             continue;
         }
 
         // Verify that any variable argument is initialized.
         if (var.id != NIL) {
-            if ((entry = containsIdEntry(var.id, TC_SCALAR, SYMTAB_SCOPE_ALL)) == NULL) {
+            if ((entry = containsIdEntry(ctx, var.id, TC_SCALAR, SYMTAB_SCOPE_ALL)) == NULL) {
                 fprintf(stderr, "Error: verifyWritelnArgs: var with id has no table entry!\n");
                 exit(EXIT_FAILURE);
             }
             if (entry->rf == 0) {
-                printWarning("Argument %d in writeln (\"%s\" \"%s\") is not initialized!",
-                i + 1, tokenClassName(entry->tc), identifierAtIndex(var.id));
+                printWarning(ctx, "Argument %d in writeln (\"%s\" \"%s\") is not initialized!",
+                i + 1, tokenClassName(entry->tc), identifierAtIndex(ctx, var.id));
             }
             continue;
         }
@@ -16,16 +16,34 @@
 */
 
 /* Returns zero and throws error if id of type-class tc isn't in symbol table. */
-unsigned existsId (unsigned id, unsigned tc);
+unsigned existsId (CompileContext *ctx, unsigned id, unsigned tc);
 
 /* Displays warning if id of type-class tc is not initialized.
   * Only checks current table scope. If id doesn't exist in scope, no warning
   * is displayed.
 */ 
-void isInitialized (unsigned id, unsigned tc);
+void isInitialized (CompileContext *ctx, unsigned id, unsigned tc);
 
 /* Returns the token-type for an identifier. Must exist in symbol table. */
-unsigned getIdTokenType (unsigned id, unsigned tc);
+unsigned getIdTokenType (CompileContext *ctx, unsigned id, unsigned tc);
+
+/*
+********************************************************************************
+*                              Constant Prototypes                             *
+********************************************************************************
+*/
+
+/* Folds an operation between the constants at value-indices `avi` and `bvi`.
+ * 1. Integer operands are folded exactly. Overflowing results are not folded.
+ * 2. Otherwise operands are promoted to reals. Comparisons result in integers.
+ * Returns the value-index of the result, or NIL if it can't be folded. An
+ * integer divisor must be nonzero. */
+unsigned foldOperation (CompileContext *ctx, unsigned operator, unsigned avi, unsigned bvi);
+
+/* Installs the integer literal of `n` digits at `text`. Returns its value-index.
+ * Literals must fit the C int they are generated as: Larger ones are an error,
+ * and have no constant value (NIL). */
+unsigned installIntegerLiteral (CompileContext *ctx, const char *text, unsigned n);
 
 /*
 ********************************************************************************
@@ -34,28 +52,28 @@ unsigned getIdTokenType (unsigned id, unsigned tc);
 */
 
 /* Throws error if expression-variable type isn't of given token-class and token-type */
-void requireExprVarType (unsigned tc, unsigned tt, varType var);
+void requireExprVarType (CompileContext *ctx, unsigned tc, unsigned tt, varType var);
 
 /* Returns resulting exprVarType of an operation between two exprVarTypes. 
  * 1. If operator involves division, throw div-zero-error if 'b' is zero.
  * 2. If any operand has no constant value, then result is just the token-type.
  * Results are type-promoted to reals if operands mismatch.  */ 
-varType resolveArithmeticOperation (unsigned operator, varType a, varType b);
+varType resolveArithmeticOperation (CompileContext *ctx, unsigned operator, varType a, varType b);
 
 /* Returns resulting exprVarType for a boolean operation between two exprVarTypes.
  * 1. If any operand is undefined, an error is thrown.
  * 2. If any operand has no constant value, then result is just type MP_INTEGER.
  * Results of comparisons are always MP_INTEGER where defined.
 */
-varType resolveBooleanOperation (unsigned operator, varType a, varType b);
+varType resolveBooleanOperation (CompileContext *ctx, unsigned operator, varType a, varType b);
 
 /* Applies a sign to a constant exprVarType. If not constant, the exprVarType
  * is simply returned.
 */
-varType applySign (unsigned operator, varType exprVarType);
+varType applySign (CompileContext *ctx, unsigned operator, varType exprVarType);
 
 /* Throws a warning if token-type of variable-expression isn't integer */
-void verifyGuardExprVar (varType var);
+void verifyGuardExprVar (CompileContext *ctx, varType var);
 
 /*
 ********************************************************************************
@@ -66,7 +84,7 @@ void verifyGuardExprVar (varType var);
 /* Extracts an IdEntry from the symbol table and initializes a varType instance.
  * Requires the IdEntry to already exist.
 */
-varType initVarTypeFromId (unsigned id, unsigned tc);
+varType initVarTypeFromId (CompileContext *ctx, unsigned id, unsigned tc);
 
 /* Resolves assignment of expression-variable to variable.
  * 1. If variable token-class is not class scalar or vector, an error is thrown.
@@ -75,7 +93,7 @@ varType initVarTypeFromId (unsigned id, unsigned tc);
  * 4. Type promotion or truncation occurs in case of mismatching primitives.
  * 5. Sets the reference flag (rf) to true.
  */ 
-void verifyAssignment (varType var, varType exprVar);
+void verifyAssignment (CompileContext *ctx, varType var, varType exprVar);
 
 /* Maps a descriptor type to a list of varTypes. Returns varListType instance */
 varListType mapDescToVarList (descType desc, varListType varList);
@@ -83,7 +101,7 @@ varListType mapDescToVarList (descType desc, varListType varList);
 /* Installs a list of varTypes into the symbol table. 
  * 1. Verifies no variable already exists in current scope
  */
-void installVarList (varListType varList);
+void installVarList (CompileContext *ctx, varListType varList);
 
 /*
 ********************************************************************************
@@ -96,22 +114,22 @@ void installVarList (varListType varList);
  * Procedures are identifier with an UNDEFINED token-type.
  * Returns nonzero if successful.
 */
-unsigned installRoutine (unsigned id, unsigned tt);
+unsigned installRoutine (CompileContext *ctx, unsigned id, unsigned tt);
 
 /* Installs all routine arguments in the symbol table under 'id'. */
-void installRoutineArgs (unsigned id, varListType varList);
+void installRoutineArgs (CompileContext *ctx, unsigned id, varListType varList);
 
 /* Verifies that expression-variable supplied to routine identified by 'id'
  * match the parameter requirements. Requires routine IdEntry exist!
  * 1) Verifies expression-variable list count matches argument count.
  * 2) Verifies expression-variable token-types match argument token-types.
 */
-void verifyRoutineArgs (unsigned id, varListType exprVarList);
+void verifyRoutineArgs (CompileContext *ctx, unsigned id, varListType exprVarList);
 
 /* Verifies that a function routine has an initialized return variable.
  * This function must be invoked before dropping the table scope level.
  */
-void verifyFunctionReturnValue (unsigned id);
+void verifyFunctionReturnValue (CompileContext *ctx, unsigned id);
 
 /*
 ********************************************************************************
@@ -122,9 +140,9 @@ void verifyFunctionReturnValue (unsigned id);
 /* Verifies all arguments supplied to readln exist and are variables.
  * Marks all arguments as initialized.
 */ 
-void verifyReadlnArgs (varListType exprVarList);
+void verifyReadlnArgs (CompileContext *ctx, varListType exprVarList);
 
 /* Verifies all arguments are either initialized variables or constants. */
-void verifyWritelnArgs (varListType exprVarList);
+void verifyWritelnArgs (CompileContext *ctx, varListType exprVarList);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <time.h>
+#include <sys/resource.h>
+#include "context.h"
+
+/*
+***************************************************************************
+*                  Internal Symbolic Constants & Variables
+***************************************************************************
+*/
+
+/* Phase names, as reported */
+static const char *phaseNames[PHASE_COUNT] = {"setup", "lex", "parse", "semantics", "irgen", "optimize", "output"};
+
+/*
+***************************************************************************
+*                           Internal Routines
+***************************************************************************
+*/
+
+/* Returns the time of the given clock in milliseconds. */
+static double clockTime (clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* Prints `s` as a JSON string. */
+static void printJsonString (FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            fprintf(fp, "\\%c", *s);
+        } else if ((unsigned char)*s < 0x20) {
+            fprintf(fp, "\\u%04x", *s);
+        } else {
+            fputc(*s, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+/*
+***************************************************************************
+*                                Routines
+***************************************************************************
+*/
+
+/* Clears the statistics of the compilation and starts timing in PHASE_SETUP. */
+void resetStats (CompileContext *ctx) {
+    ctx->stats = (CompileStats){.cached = 0};
+    ctx->clock.phase = PHASE_SETUP;
+    ctx->clock.lastWall = clockTime(CLOCK_MONOTONIC);
+    ctx->clock.lastCpu = clockTime(CLOCK_THREAD_CPUTIME_ID);
+}
+
+/* Charges the time since the last switch to the current phase, then switches
+ * to phase `p`. Returns the previous phase. Does nothing unless in stats mode. */
+Phase enterPhase (CompileContext *ctx, Phase p) {
+    PhaseClock *clock = &ctx->clock;
+    Phase prev = clock->phase;
+    double wall, cpu;
+
+    if (!ctx->options.stats) {
+        return p;
+    }
+    wall = clockTime(CLOCK_MONOTONIC);
+    cpu = clockTime(CLOCK_THREAD_CPUTIME_ID);
+    ctx->stats.wall[prev] += wall - clock->lastWall;
+    ctx->stats.cpu[prev] += cpu - clock->lastCpu;
+    clock->lastWall = wall;
+    clock->lastCpu = cpu;
+    clock->phase = p;
+    return prev;
+}
+
+/* Prints the statistics of the last compilation of `name` to `fp`, as text or
+ * JSON. Peak memory is that of the whole process. */
+void printStats (CompileContext *ctx, FILE *fp, const char *name) {
+    CompileStats stats = ctx->stats;
+    double wall = 0.0, cpu = 0.0;
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        wall += stats.wall[i];
+        cpu += stats.cpu[i];
+    }
+
+    if (ctx->options.stats == STATS_JSON) {
+        fprintf(fp, "{\"file\": ");
+        printJsonString(fp, name);
+        fprintf(fp, ", \"cached\": %s, \"phases\": {", stats.cached ? "true" : "false");
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            fprintf(fp, "%s\"%s\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f}", (i > 0 ? ", " : ""),
+                phaseNames[i], stats.wall[i], stats.cpu[i]);
+        }
+        fprintf(fp, "}, \"total\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f}, \"peak_rss_kb\": %ld, ",
+            wall, cpu, usage.ru_maxrss);
+        fprintf(fp, "\"strtab\": {\"used\": %u, \"size\": %u}, \"numtab\": {\"used\": %u, \"size\": %u}, ",
+            stats.strUsed, stats.strSize, stats.numUsed, stats.numSize);
+        fprintf(fp, "\"symtab\": {\"entries\": %u, \"slots\": %u, \"mean_probe\": %.3f, \"longest_probe\": %u}, ",
+            stats.symEntries, stats.symSlots, stats.symMeanProbe, stats.symLongest);
+        fprintf(fp, "\"ast\": {\"built\": %u, \"peak\": %u}, ", stats.astBuilt, stats.astPeak);
+        fprintf(fp, "\"ir\": {\"built\": %u, \"emitted\": %u, \"declared\": %u}, ", stats.irBuilt, stats.irEmitted, stats.irDeclared);
+        fprintf(fp, "\"temps\": %u, \"labels\": %u}\n", stats.temps, stats.labels);
+        return;
+    }
+
+    fprintf(fp, "Statistics for \"%s\"%s:\n", name, stats.cached ? " (cached)" : "");
+    fprintf(fp, "  %-10s %10s %10s\n", "phase", "wall (ms)", "cpu (ms)");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        fprintf(fp, "  %-10s %10.3f %10.3f\n", phaseNames[i], stats.wall[i], stats.cpu[i]);
+    }
+    fprintf(fp, "  %-10s %10.3f %10.3f\n", "total", wall, cpu);
+    fprintf(fp, "  Peak memory:  %ld KiB\n", usage.ru_maxrss);
+    fprintf(fp, "  strTable:     %u of %u bytes\n", stats.strUsed, stats.strSize);
+    fprintf(fp, "  numTable:     %u of %u constants\n", stats.numUsed, stats.numSize);
+    fprintf(fp, "  symTable:     %u entries in %u slots, %.2f mean probe (longest %u)\n",
+        stats.symEntries, stats.symSlots, stats.symMeanProbe, stats.symLongest);
+    fprintf(fp, "  Syntax tree:  %u nodes built, at most %u held\n", stats.astBuilt, stats.astPeak);
+    fprintf(fp, "  Code:         %u instructions built, %u emitted, %u temporaries declared\n",
+            stats.irBuilt, stats.irEmitted, stats.irDeclared);
+    fprintf(fp, "  Labels:       %u T-Labels, %u L-Labels\n", stats.temps, stats.labels);
+}
@@ -0,0 +1,82 @@
+#if !defined(STATS_H)
+#define STATS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+***************************************************************************
+*                        Compilation Statistics                           *
+* AUTHORS: Charles Randolph, Joe Jones.                                   *
+* SNUMBERS: s2897318, s2990652.                                           *
+***************************************************************************
+*/
+
+/*
+***************************************************************************
+*                     Type Definitions & Global Variables
+***************************************************************************
+*/
+
+// Statistics Modes: Compilations are timed and reported as text or JSON.
+#define STATS_TEXT          1
+#define STATS_JSON          2
+
+/* Compilation phases. Time outside the others is charged to PHASE_SETUP */
+typedef enum {
+    PHASE_SETUP,
+    PHASE_LEX,
+    PHASE_PARSE,
+    PHASE_SEMANTICS,
+    PHASE_IRGEN,
+    PHASE_OPTIMIZE,
+    PHASE_OUTPUT,
+    PHASE_COUNT
+} Phase;
+
+/* Statistics of a compilation */
+typedef struct {
+    double wall[PHASE_COUNT];       // Wall-clock time per phase (ms).
+    double cpu[PHASE_COUNT];        // Thread CPU time per phase (ms).
+    int cached;                     // Nonzero if served from the cache.
+    unsigned strUsed, strSize;      // String table bytes used and allocated.
+    unsigned numUsed, numSize;      // Number table constants used and allocated.
+    unsigned symEntries, symSlots;  // Symbol table entries and slots.
+    double symMeanProbe;            // Mean slots visited per symbol lookup.
+    unsigned symLongest;            // Longest symbol table probe sequence.
+    unsigned temps, labels;         // T-Labels and L-Labels generated.
+    unsigned astBuilt, astPeak;     // Syntax tree nodes built, and most held at once.
+    unsigned irBuilt, irEmitted;    // Three-address instructions built, and emitted after optimization.
+    unsigned irDeclared;            // T-Labels declared in the C.
+} CompileStats;
+
+/* The current phase of a compilation and the time it was entered */
+typedef struct {
+    Phase phase;
+    double lastWall, lastCpu;
+} PhaseClock;
+
+/* The context of a compilation (see context.h) */
+typedef struct compileContext CompileContext;
+
+/* Runs the statements in phase `p` of compilation `ctx`, then returns to the previous phase */
+#define IN_PHASE(ctx, p, ...)   do { Phase prev_ = enterPhase(ctx, p); __VA_ARGS__; enterPhase(ctx, prev_); } while (0)
+
+/*
+***************************************************************************
+*                           Routine Prototypes
+***************************************************************************
+*/
+
+/* Clears the statistics of the compilation and starts timing in PHASE_SETUP. */
+void resetStats (CompileContext *ctx);
+
+/* Charges the time since the last switch to the current phase, then switches
+ * to phase `p`. Returns the previous phase. Does nothing unless in stats mode. */
+Phase enterPhase (CompileContext *ctx, Phase p);
+
+/* Prints the statistics of the last compilation of `name` to `fp`, as text or
+ * JSON. Peak memory is that of the whole process. */
+void printStats (CompileContext *ctx, FILE *fp, const char *name);
+
+#endif
@@ -1,4 +1,4 @@
-#include "strtab.h"
+#include "context.h"
 
 /*
 ********************************************************************************
@@ -7,13 +7,14 @@
 */
 
 #define STRTAB_DEFAULT_SIZE     512
+#define STRTAB_INDEX_SIZE       256
 #define MAX(a,b)                ((a) > (b) ? (a) : (b))
 
-// String table.
-char *strTable;
-
-// Points to the front of the concatenated string table.
-unsigned sp, strTableSize;
+// Each string is stored as: <hash (unsigned)> <characters> '\0' <padding>.
+// Identifiers index the characters, so the hash lies just before them. Entries
+// are padded to the alignment of the hash.
+#define HASH_SIZE               sizeof(unsigned)
+#define ALIGN(n)                (((n) + HASH_SIZE - 1) & ~(HASH_SIZE - 1))
 
 /*
 ********************************************************************************
@@ -21,19 +22,79 @@ unsigned sp, strTableSize;
 ********************************************************************************
 */
 
-static void resizeStringTable (unsigned newSize) {
-    if (newSize < strTableSize) {
+static void resizeStringTable (StringTable *st, unsigned newSize) {
+    if (newSize < st->size) {
         fprintf(stderr, "Error: strtab: Can't resize table to smaller size!\n");
         exit(EXIT_FAILURE);
     }
 
-    if ((strTable = realloc(strTable, newSize * sizeof(char))) == NULL) {
+    if ((st->table = realloc(st->table, newSize * sizeof(char))) == NULL) {
         fprintf(stderr, "Error: strtab: Couldn't resize string table!\n");
         exit(EXIT_FAILURE);
     }
-    strTableSize = newSize;
+    st->size = newSize;
+}
+
+/* Returns the hash stored before the identifier at index `id`. */
+static unsigned storedHash (StringTable *st, unsigned id) {
+    unsigned hash;
+    memcpy(&hash, st->table + id - HASH_SIZE, HASH_SIZE);
+    return hash;
+}
+
+/* Jenkins one-at-a-time hash of the `len` characters at `s`. */
+static unsigned hashString (const char *s, unsigned len) {
+    unsigned i, hash = 0;
+
+    for (i = 0; i < len; ++i) {
+        hash += (unsigned char)s[i];
+        hash += (hash << 10);
+        hash ^= (hash >> 6);
+    }
+
+    hash += (hash << 3);
+    hash ^= (hash >> 11);
+    hash += (hash << 15);
+
+    return hash;
 }
 
+/* Returns the slot of the index holding the `len` characters at `identifier`,
+ * or the empty slot they belong in. */
+static unsigned indexSlot (StringTable *st, unsigned hash, const char *identifier, unsigned len) {
+    unsigned mask = st->indexSize - 1, i = hash & mask, id;
+
+    while (st->index[i] != 0) {
+        id = st->index[i] - 1;
+        if (storedHash(st, id) == hash && id + len < st->sp && 
+            memcmp(st->table + id, identifier, len) == 0 && st->table[id + len] == '\0') {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/* Allocates an empty index of `size` slots and reinserts all strings. */
+static void resizeStringIndex (StringTable *st, unsigned size) {
+    unsigned id;
+
+    free(st->index);
+    if ((st->index = calloc(size, sizeof(unsigned))) == NULL) {
+        fprintf(stderr, "Error: strtab: Couldn't allocate index!\n");
+        exit(EXIT_FAILURE);
+    }
+    st->indexSize = size;
+
+    // Strings are unique, so each only needs an empty slot.
+    for (id = HASH_SIZE; id < st->sp; id += ALIGN(strlen(st->table + id) + 1) + HASH_SIZE) {
+        unsigned i = storedHash(st, id) & (size - 1);
+        while (st->index[i] != 0) {
+            i = (i + 1) & (size - 1);
+        }
+        st->index[i] = id + 1;
+    }
+}
 
 /*
 ********************************************************************************
@@ -41,60 +102,91 @@ static void resizeStringTable (unsigned newSize) {
 ********************************************************************************
 */
 
-/* Initializes the string table */
-void initStringTable () {
-    strTableSize = STRTAB_DEFAULT_SIZE;
-    if ((strTable = malloc(strTableSize * sizeof(char))) == NULL) {
+/* Initializes the string table. An existing table is emptied, keeping its allocation */
+void initStringTable (CompileContext *ctx) {
+    StringTable *st = &ctx->strtab;
+
+    st->sp = st->count = 0;
+    if (st->table != NULL) {
+        memset(st->index, 0, st->indexSize * sizeof(unsigned));
+        return;
+    }
+    st->size = STRTAB_DEFAULT_SIZE;
+    if ((st->table = malloc(st->size * sizeof(char))) == NULL) {
         fprintf(stderr, "Error: strtab: Couldn't allocate table!\n");
         exit(EXIT_FAILURE);
     }
+    resizeStringIndex(st, STRTAB_INDEX_SIZE);
 }
 
 /* Returns index of installed identifier. If not yet in table, it is created. */
-unsigned installId (const char *identifier) {
-    int p = 0, len = strlen(identifier);
+unsigned installId (CompileContext *ctx, const char *identifier) {
+    return installIdSpan(ctx, identifier, strlen(identifier));
+}
 
-    // Try to locate identifier.
-    while (p < sp) {
-        if (strcmp(strTable + p, identifier) == 0) {
-            return p;
-        }
-        p += strlen(strTable + p) + 1;
+/* Returns index of the identifier of `len` characters at `identifier`, which
+ * needn't be terminated. Only copied into the table if not yet installed. */
+unsigned installIdSpan (CompileContext *ctx, const char *identifier, unsigned len) {
+    StringTable *st = &ctx->strtab;
+    unsigned hash = hashString(identifier, len), i = indexSlot(st, hash, identifier, len), id;
+
+    // Located identifier.
+    if (st->index[i] != 0) {
+        return st->index[i] - 1;
     }
 
-    // Must not exist, resize if necessary and install it.
-    if (p + len + 1 > strTableSize) {
-        resizeStringTable(MAX(strTableSize * 2, p + len + 1));
+    // Must not exist, resize if necessary and install it after its hash.
+    id = st->sp + HASH_SIZE;
+    if (id + ALIGN(len + 1) > st->size) {
+        resizeStringTable(st, MAX(st->size * 2, id + ALIGN(len + 1)));
+    }
+    memcpy(st->table + st->sp, &hash, HASH_SIZE);
+    memcpy(st->table + id, identifier, len);
+    st->table[id + len] = '\0';
+    st->sp = id + ALIGN(len + 1);
+
+    // Keep the index at most half full.
+    st->index[i] = id + 1;
+    if (++st->count > st->indexSize / 2) {
+        resizeStringIndex(st, st->indexSize * 2);
     }
-    strcpy(strTable + p, identifier);
-    sp = p + len + 1;
-    
-    return p;
+    return id;
+}
+
+/* Returns the hash of the identifier at the given index. Computed once, on installation */
+unsigned identifierHash (CompileContext *ctx, unsigned id) {
+    return storedHash(&ctx->strtab, id);
 }
 
 /* Returns pointer to identifier lexeme at given index in the string table */
-const char *identifierAtIndex (unsigned id) {
-    if (id >= sp) {
+const char *identifierAtIndex (CompileContext *ctx, unsigned id) {
+    if (id >= ctx->strtab.sp) {
         fprintf(stderr, "Error: strtab: Given index out of bounds!\n");
         exit(EXIT_FAILURE);
     }
-    return strTable + id;
+    return ctx->strtab.table + id;
+}
+
+/* Returns the number of bytes in use, storing the allocated size in `size` */
+unsigned stringTableUsage (CompileContext *ctx, unsigned *size) {
+    *size = ctx->strtab.size;
+    return ctx->strtab.sp;
 }
 
 /* Frees the string table */
-void freeStringTable () {
-    free(strTable);
+void freeStringTable (CompileContext *ctx) {
+    free(ctx->strtab.table);
+    free(ctx->strtab.index);
+    ctx->strtab = (StringTable){.table = NULL, .index = NULL};
 }
 
 /* Debug Method: Prints state of the table. */
-void printStringTable() {
-    printf("Size = %u\nHead = %u\nTable = [", strTableSize, sp);
-    for (int i = 0; i < sp; i++) {
-        if (strTable[i] == '\0') {
-            putchar(',');
-        } else {
-            putchar(strTable[i]);
-        }
+void printStringTable (CompileContext *ctx) {
+    StringTable *st = &ctx->strtab;
+
+    printf("Size = %u\nHead = %u\nCount = %u\nTable = [", st->size, st->sp, st->count);
+    for (unsigned id = HASH_SIZE; id < st->sp; id += ALIGN(strlen(st->table + id) + 1) + HASH_SIZE) {
+        printf("%s%s:%08x", (id > HASH_SIZE ? "," : ""), st->table + id, storedHash(st, id));
     }
     printf("]\n");
 }
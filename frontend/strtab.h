@@ -13,25 +13,53 @@
     ***************************************************************************
 */
 
+/*
+********************************************************************************
+*                               Type Definitions                               *
+********************************************************************************
+*/
+
+// The context of a compilation (see context.h).
+typedef struct compileContext CompileContext;
+
+// String table: Concatenated identifiers, each preceded by its hash. A hash
+// index maps identifiers to their table index.
+typedef struct {
+    char *table;                // Concatenated identifiers.
+    unsigned sp, size;          // Front of the table, and its allocated size.
+    unsigned *index;            // Hash index: Open addressing with linear probing.
+    unsigned indexSize, count;  // Slots of the index, and identifiers installed.
+} StringTable;
+
 /*
 ********************************************************************************
 *                             String Table Routines                            *
 ********************************************************************************
 */
 
-/* Initializes the string table */
-void initStringTable ();
+/* Initializes the string table. An existing table is emptied, keeping its allocation */
+void initStringTable (CompileContext *ctx);
 
 /* Returns index of installed identifier. If not yet in table, it is created */
-unsigned installId (const char *identifier);
+unsigned installId (CompileContext *ctx, const char *identifier);
+
+/* Returns index of the identifier of `len` characters at `identifier`, which
+ * needn't be terminated (e.g. a span of the source). Copied only if new */
+unsigned installIdSpan (CompileContext *ctx, const char *identifier, unsigned len);
+
+/* Returns the hash of the identifier at the given index. Computed once, on installation */
+unsigned identifierHash (CompileContext *ctx, unsigned id);
 
 /* Returns pointer to identifier lexeme at given index in the string table */
-const char *identifierAtIndex (unsigned id);
+const char *identifierAtIndex (CompileContext *ctx, unsigned id);
+
+/* Returns the number of bytes in use, storing the allocated size in `size` */
+unsigned stringTableUsage (CompileContext *ctx, unsigned *size);
 
 /* Frees the string table */
-void freeStringTable ();
+void freeStringTable (CompileContext *ctx);
 
 /* Debug Method: Prints state of the table. */
-void printStringTable();
+void printStringTable (CompileContext *ctx);
 
 #endif
\ No newline at end of file
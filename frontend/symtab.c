@@ -1,4 +1,4 @@
-#include "symtab.h"
+#include "context.h"
 
 /*
 ********************************************************************************
@@ -6,23 +6,8 @@
 ********************************************************************************
 */
 
-// Elementary linked-list structure.
-typedef struct node {
-    IdEntry *entry;
-    struct node *next;
-} Node;
-
-// Prime symbol-table size.
-#define SYMTAB_SIZE     6959
-
-// Symbol-table levels.
-#define SYMTAB_LVLS     2
-
-// Symbol table.
-Node *symTable[SYMTAB_SIZE][SYMTAB_LVLS];
-
-// Table scope level.
-unsigned lvl;
+// Initial symbol-table size. Always a power of two.
+#define SYMTAB_DEFAULT_SIZE     256
 
 /*
 ********************************************************************************
@@ -48,121 +33,103 @@ static void freeIdData (IdData *data) {
     free(data->argv);
 }
 
-/* Frees an IdEntry instance */
+/* Frees the data of an IdEntry instance */
 static void freeIdEntry (IdEntry *entry) {
-
-    if (entry == NULL) {
-        return;
-    }
-
     if (entry->tc == TC_ROUTINE) {
         freeIdData(&(entry->data));
     }
-
-    free(entry);
 }
 
 /*
 ********************************************************************************
-*                          Internal Linked List Routines                       *
+*                         Internal Table Control Routines                      *
 ********************************************************************************
 */
 
-/* Allocates new list-node and returns its pointer. Returns NULL on error. */
-static Node *newNode (IdEntry *entry, Node *next) {
-    Node *n = NULL;
-    if ((n = malloc(sizeof(Node))) == NULL) {
-        fprintf(stderr, "Error: newNode: Couldn't initialize new list node!\n");
-        exit(EXIT_FAILURE);
-    }
-    n->entry = entry;
-    n->next = next;
-    return n;
-}
-
-/* Allocates a new node and inserts it in front of given node list. */
-static Node *insertNode (IdEntry *entry, Node *lp) {
-    return newNode(entry, lp);
+/* Returns the home slot of identifier `id`. The string table keeps the Jenkins
+ * hash (Looted from Meijster's symtab) of each identifier. */
+static unsigned hash (CompileContext *ctx, unsigned id) {
+    return identifierHash(ctx, id) & (ctx->symtab.size - 1);
 }
 
-/* Frees linked-list of nodes. */
-static void freeNodes (Node *lp) {
-    if (lp == NULL) {
-        return;
+/* Grows the array `a` of `size` elements to hold at least `n` elements. */
+static unsigned *growArray (unsigned *a, unsigned *size, unsigned n) {
+    if (n <= *size) {
+        return a;
     }
-    freeNodes(lp->next);
-    freeIdEntry(lp->entry);
-    free(lp);
-}
-
-/* Returns pointer to node containing IdEntry identified by identifier and class.
- * If the list does not contain an entry, a NULL pointer is returned.
-*/
-static Node *listContains (unsigned id, unsigned tc, Node *lp) {
-    if (lp == NULL) {
-        return NULL;
-    }
-    if ((lp->entry->tc == tc || tc == (unsigned)TC_ANY) && lp->entry->id == id) {
-        return lp;
+    *size = (2 * *size > n ? 2 * *size : n);
+    if ((a = realloc(a, *size * sizeof(unsigned))) == NULL) {
+        fprintf(stderr, "Error: symtab: Couldn't resize scope stack!\n");
+        exit(EXIT_FAILURE);
     }
-    return listContains(id, tc, lp->next);
+    return a;
 }
 
-/* Debug method: prints linked-list. */
-static void printList (Node *lp) {
-    if (lp == NULL) {
-        printf("[NULL]");
-    } else {
-        printf("[%s : %s : %s]->", identifierAtIndex(lp->entry->id), tokenClassName(lp->entry->tc), tokenTypeName(lp->entry->tt ));
-        printList(lp->next);
+/* Returns the first empty slot on the probe sequence of `id`. */
+static unsigned emptySlot (CompileContext *ctx, unsigned id) {
+    SymbolTable *st = &ctx->symtab;
+    unsigned i = hash(ctx, id);
+    while (st->table[i].depth != 0) {
+        i = (i + 1) & (st->size - 1);
     }
+    return i;
 }
 
-/*
-********************************************************************************
-*                         Internal Table Control Routines                      *
-********************************************************************************
-*/
-
-/* Jenkins hash function: Looted from Meijster's symtab. */
-static unsigned hash (const char *s) {
-    unsigned i, hash = 0, len = strlen(s);
+/* Replaces the table by one of `size` slots, reinserting all entries in
+ * order of installation. This keeps every probe sequence passing only
+ * through older entries, which popScopeStack depends on. */
+static void resizeSymbolTable (CompileContext *ctx, unsigned size) {
+    SymbolTable *st = &ctx->symtab;
+    Slot *old = st->table;
 
-    for(i = 0; i < len; ++i) {
-        hash += s[i];
-        hash += (hash << 10);
-        hash ^= (hash >> 6);
-    }
-
-    hash += (hash << 3);
-    hash ^= (hash >> 11);
-    hash += (hash << 15);
-
-    return hash % SYMTAB_SIZE;
-}
-
-/* Sets the current table scope level. If invalid, an error is thrown. */
-static void setLevel (unsigned level) {
-    if (level >= SYMTAB_LVLS) {
-        printError("Maximum scope level exceeded!");
+    if ((st->table = calloc(size, sizeof(Slot))) == NULL) {
+        fprintf(stderr, "Error: symtab: Couldn't allocate table!\n");
         exit(EXIT_FAILURE);
     }
-    lvl = level;
+    st->size = size;
+    for (unsigned k = 0; k < st->scopeTop; k++) {
+        Slot *s = &old[st->scopeStack[k]];
+        st->scopeStack[k] = emptySlot(ctx, s->entry.id);
+        st->table[st->scopeStack[k]] = *s;
+    }
+    free(old);
 }
 
-/* Frees all memory in a given scope level. */
-static void freeSymbolTableLevel (unsigned level) {
-    if (level >= SYMTAB_LVLS) {
-        fprintf(stderr, "Error: freeSymbolTableLevel: Specified scope out of bounds!\n");
-        exit(EXIT_FAILURE);
-    }
+/* Returns the most recent entry identified by identifier and class, at scope
+ * `level` or any level if SYMTAB_SCOPE_ALL. NULL if there is none. The whole
+ * probe sequence is searched, since more recent entries lie further along it. */
+static IdEntry *tableContains (CompileContext *ctx, unsigned id, unsigned tc, int level) {
+    SymbolTable *st = &ctx->symtab;
+    unsigned i, n = 0;
+    Slot *found = NULL, *s;
 
-    for (unsigned i = 0; i < SYMTAB_SIZE; i++) {
-        freeNodes(symTable[i][level]);
-        symTable[i][level] = NULL;
+    if (st->table == NULL) {
+        return NULL;
+    }
+    // Only the occupied slots compared count as probes, not the empty slot ending the search.
+    for (i = hash(ctx, id); (s = &st->table[i])->depth != 0; i = (i + 1) & (st->size - 1), n++) {
+        if (s->entry.id == id && (s->entry.tc == tc || tc == (unsigned)TC_ANY) &&
+            (level == SYMTAB_SCOPE_ALL || s->depth == level + 1) && (found == NULL || s->seq > found->seq)) {
+            found = s;
+        }
     }
+
+    st->lookups++;
+    st->probes += n;
+    st->longestProbe = (n > st->longestProbe ? n : st->longestProbe);
+    return (found == NULL ? NULL : &found->entry);
 }
 
+/* Removes and frees the entries installed since scope stack position `mark`.
+ * The most recent entry is never passed by another probe sequence, so
+ * emptying its slot leaves all other entries reachable. */
+static void popScopeStack (SymbolTable *st, unsigned mark) {
+    while (st->scopeTop > mark) {
+        Slot *s = &st->table[st->scopeStack[--st->scopeTop]];
+        freeIdEntry(&s->entry);
+        s->depth = 0;
+    }
+}
 
 /*
 ********************************************************************************
@@ -173,17 +140,14 @@ static void freeSymbolTableLevel (unsigned level) {
 /* Copies an IdEntry and returns a pointer. Exits on error. */
 IdEntry *copyIdEntry (IdEntry *entry) {
     IdEntry *copy = allocateIdEntry(); 
-    copy->id = entry->id;
-    copy->tc = entry->tc;
-    copy->tt = entry->tt;
-    copy->rf = entry->rf;
-    copy->data = entry->data;
+    *copy = *entry;
     return copy;
 }
 
 
 /* Returns pointer to IdEntry if in the symbol-table. Otherwise returns NULL.
- * An IdEntry is uniquely identified by combination (id, tc).
+ * An IdEntry is uniquely identified by combination (id, tc). The pointer is
+ * valid until the next installation.
  * Parameters:
  * - id: The identifier-index.
  *
@@ -193,56 +157,42 @@ IdEntry *copyIdEntry (IdEntry *entry) {
  * - scope: The search scope. If not positive integer, all descending
  *          scope levels are traversed. Otherwise literal value used.
 */
-IdEntry *containsIdEntry (unsigned id, unsigned tc, int scope) {
-    unsigned h = hash(identifierAtIndex(id));
-    Node *lp = NULL;
-
-    if (scope == SYMTAB_SCOPE_ALL) {
-        for (int l = lvl; l >= 0; l--) {
-            if ((lp = listContains(id, tc, symTable[h][l])) != NULL) {
-                return lp->entry;
-            }
-        }
-        return NULL;
-    } 
-
-    if (scope < SYMTAB_SCOPE_ALL || scope >= SYMTAB_LVLS) {
+IdEntry *containsIdEntry (CompileContext *ctx, unsigned id, unsigned tc, int scope) {
+    if (scope < SYMTAB_SCOPE_ALL || (scope != SYMTAB_SCOPE_ALL && scope > ctx->symtab.lvl)) {
         fprintf(stderr, "Error: containsIdEntry: Scope out of bounds!\n");
         exit(EXIT_FAILURE);
     }
-
-    if ((lp = listContains(id, tc, symTable[h][scope])) != NULL) {
-        return lp->entry;
-    }
-
-    return NULL;
+    return tableContains(ctx, id, tc, scope);
 }
 
 
-/* Allocates and installs new IdEntry into the symbol table at current scope.
- * Returns pointer if successful. Duplicate entry must not already exist. 
+/* Installs new IdEntry into the symbol table at current scope. Returns
+ * pointer if successful, valid until the next installation. Duplicate entry
+ * must not already exist. 
 */
-IdEntry *installIdEntry (unsigned id, unsigned tc, unsigned tt) {
-    IdEntry *entry = allocateIdEntry();
-    unsigned h = hash(identifierAtIndex(id));
-    Node *lp = NULL;
+IdEntry *installIdEntry (CompileContext *ctx, unsigned id, unsigned tc, unsigned tt) {
+    SymbolTable *st = &ctx->symtab;
+    unsigned i;
 
     // Verify entry does not exist yet.
-    if ((lp = listContains(id, tc, symTable[h][lvl])) != NULL) {
+    if (tableContains(ctx, id, tc, st->lvl) != NULL) {
         fprintf(stderr, "Error: installIdEntry: Entry already exists in table!\n");
         exit(EXIT_FAILURE);
     }
 
-    // Assign entry fields.
-    entry->id = id;
-    entry->tc = tc;
-    entry->tt = tt;
-    entry->rf = 0;
-    entry->data = (IdData){.argc = 0, .argv = NULL};
+    // Keep the table at most half full.
+    st->scopeStack = growArray(st->scopeStack, &st->scopeSize, st->scopeTop + 1);
+    if (st->table == NULL || 2 * (st->scopeTop + 1) > st->size) {
+        resizeSymbolTable(ctx, st->table == NULL ? SYMTAB_DEFAULT_SIZE : 2 * st->size);
+    }
 
-    // Insert new entry at list head. Then return pointer to entry.
-    symTable[h][lvl] = insertNode(entry, symTable[h][lvl]);
-    return symTable[h][lvl]->entry;
+    // Assign entry fields in the first empty slot, and record it on the scope stack.
+    i = emptySlot(ctx, id);
+    st->table[i] = (Slot){.depth = st->lvl + 1, .seq = st->scopeTop};
+    st->table[i].entry = (IdEntry){.id = id, .tc = tc, .tt = tt, .rf = 0, .vb = 0, .vl = 0,
+        .data = (IdData){.argc = 0, .argv = NULL}};
+    st->scopeStack[st->scopeTop++] = i;
+    return &st->table[i].entry;
 }
 
 /*
@@ -252,36 +202,55 @@ IdEntry *installIdEntry (unsigned id, unsigned tc, unsigned tt) {
 */
 
 /* Increments table scope level */
-void incrementTableScope (void) {
-    setLevel(lvl + 1);
+void incrementTableScope (CompileContext *ctx) {
+    SymbolTable *st = &ctx->symtab;
+    st->scopeMarks = growArray(st->scopeMarks, &st->marksSize, st->lvl + 2);
+    st->scopeMarks[++st->lvl] = st->scopeTop;
 }
 
-/* Decrements table scope level: Frees memory in current scope */
-void decrementTableScope (void) {
-    freeSymbolTableLevel(lvl);
-    setLevel(lvl - 1);
+/* Decrements table scope level: Frees the entries installed in the current scope */
+void decrementTableScope (CompileContext *ctx) {
+    SymbolTable *st = &ctx->symtab;
+    if (st->lvl == 0) {
+        fprintf(stderr, "Error: decrementTableScope: Already at the outermost scope!\n");
+        exit(EXIT_FAILURE);
+    }
+    popScopeStack(st, st->scopeMarks[st->lvl--]);
 }
 
 /* Returns the table scope level */
-unsigned currentTableScope (void) {
-    return lvl;
+unsigned currentTableScope (CompileContext *ctx) {
+    return ctx->symtab.lvl;
 }
 
-/* Frees all allocated entires in all table levels */
-void freeSymbolTables (void) {
-    for (int i = lvl; i >= 0; i--) {
-        freeSymbolTableLevel(i);
-    }
+/* Reports the entries and slots of the table, the mean number of entries compared
+ * per lookup and the longest probe sequence since the tables were last freed */
+void symbolTableUsage (CompileContext *ctx, unsigned *entries, unsigned *slots, double *meanProbe, unsigned *longest) {
+    SymbolTable *st = &ctx->symtab;
+    *entries = st->scopeTop;
+    *slots = st->size;
+    *meanProbe = (st->lookups > 0 ? (double)st->probes / st->lookups : 0.0);
+    *longest = st->longestProbe;
+}
+
+/* Frees all allocated entires in all table levels. Resets the scope level */
+void freeSymbolTables (CompileContext *ctx) {
+    SymbolTable *st = &ctx->symtab;
+    popScopeStack(st, 0);
+    free(st->table);
+    free(st->scopeStack);
+    free(st->scopeMarks);
+    *st = (SymbolTable){.table = NULL, .scopeStack = NULL, .scopeMarks = NULL};
 }
 
 /* Prints all symbol table entires */
-void printSymbolTables (void) {
-    for (int i = 0; i < SYMTAB_LVLS; i++) {
-        printf("****************************** LEVEL %u ******************************\n", i);
-        for (int j = 0; j < SYMTAB_SIZE; j++) {
-            if (symTable[j][i] != NULL) {
-                printf("%d.\t", j); printList(symTable[j][i]); putchar('\n');
-            }
-        }
+void printSymbolTables (CompileContext *ctx) {
+    SymbolTable *st = &ctx->symtab;
+    printf("****************************** LEVEL %u ******************************\n", st->lvl);
+    for (unsigned k = 0; k < st->scopeTop; k++) {
+        unsigned i = st->scopeStack[k];
+        IdEntry *e = &st->table[i].entry;
+        printf("%u.\t[%s : %s : %s : %u]\n", i, identifierAtIndex(ctx, e->id), tokenClassName(e->tc), 
+            tokenTypeName(e->tt), st->table[i].depth - 1);
     }
 }
@@ -40,9 +40,31 @@ typedef struct {
     unsigned tc;        // Type-class: Routine / Vector / Scalar
     unsigned tt;        // Token-type.
     unsigned rf;        // Referenced boolean flag.
+    unsigned vb;        // Vector-Bound.
+    unsigned vl;        // Vector-Length.
     IdData data;        // Type data.
 } IdEntry;
 
+/* Table slot. Entries are stored inline */
+typedef struct {
+    IdEntry entry;
+    unsigned depth;     // Scope level + 1. Zero marks an empty slot.
+    unsigned seq;       // Position on the scope stack: Higher is more recent.
+} Slot;
+
+/* Symbol table. Open addressing with linear probing, kept at most half full */
+typedef struct {
+    Slot *table;                    // Slots. The size is a power of two.
+    unsigned size;
+    unsigned *scopeStack;           // The slot of every entry, in order of installation.
+    unsigned scopeTop, scopeSize;
+    unsigned *scopeMarks;           // Start of each open scope level in the scope stack.
+    unsigned marksSize;
+    unsigned lvl;                   // Table scope level.
+    unsigned long lookups, probes;  // Lookups and the occupied slots compared by them.
+    unsigned longestProbe;          // Longest probe sequence.
+} SymbolTable;
+
 /*
 ********************************************************************************
 *                           Table IdEntry Prototypes                           *
@@ -53,7 +75,8 @@ typedef struct {
 IdEntry *copyIdEntry (IdEntry *entry);
 
 /* Returns pointer to IdEntry if in the symbol-table. Otherwise returns NULL.
- * An IdEntry is uniquely identified by combination (id, tc).
+ * An IdEntry is uniquely identified by combination (id, tc). The pointer is
+ * valid until the next installation.
  * Parameters:
  * - id: The identifier-index.
  *
@@ -63,12 +86,13 @@ IdEntry *copyIdEntry (IdEntry *entry);
  * - scope: The search scope. If not positive integer, all descending
  *          scope levels are traversed. Otherwise literal value used.
 */
-IdEntry *containsIdEntry (unsigned id, unsigned tc, int scope);
+IdEntry *containsIdEntry (CompileContext *ctx, unsigned id, unsigned tc, int scope);
 
-/* Allocates and installs new IdEntry into the symbol table at current scope.
- * Returns pointer if successful. Duplicate entry must not already exist. 
+/* Installs new IdEntry into the symbol table at current scope. Returns
+ * pointer if successful, valid until the next installation. Duplicate entry
+ * must not already exist. 
 */
-IdEntry *installIdEntry (unsigned id, unsigned tc, unsigned tt);
+IdEntry *installIdEntry (CompileContext *ctx, unsigned id, unsigned tc, unsigned tt);
 
 /*
 ********************************************************************************
@@ -77,18 +101,22 @@ IdEntry *installIdEntry (unsigned id, unsigned tc, unsigned tt);
 */
 
 /* Increments table scope level */
-void incrementTableScope (void);
+void incrementTableScope (CompileContext *ctx);
 
-/* Decrements table scope level: Frees memory in current scope */
-void decrementTableScope (void);
+/* Decrements table scope level: Frees the entries installed in the current scope */
+void decrementTableScope (CompileContext *ctx);
 
 /* Returns the table scope level */
-unsigned currentTableScope (void);
+unsigned currentTableScope (CompileContext *ctx);
+
+/* Reports the entries and slots of the table, the mean number of entries compared
+ * per lookup and the longest probe sequence since the tables were last freed */
+void symbolTableUsage (CompileContext *ctx, unsigned *entries, unsigned *slots, double *meanProbe, unsigned *longest);
 
-/* Frees all allocated entires in all table levels */
-void freeSymbolTables (void);
+/* Frees all allocated entires in all table levels. Resets the scope level */
+void freeSymbolTables (CompileContext *ctx);
 
 /* Prints all symbol table entires */
-void printSymbolTables (void);
+void printSymbolTables (CompileContext *ctx);
 
 #endif
\ No newline at end of file
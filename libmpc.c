@@ -0,0 +1,167 @@
+#include <string.h>
+#include "libmpc.h"
+#include "compile.h"        // Compilation driver.
+
+/*
+***************************************************************************
+*                  Internal Symbolic Constants & Variables
+***************************************************************************
+*/
+
+/* Initial number of diagnostics allocated in a result */
+#define MPC_DEFAULT_DIAGNOSTICS 8
+
+/* A compiler instance: The context of its compilations */
+struct mpcCompiler {
+    CompileContext ctx;
+};
+
+/* Collects the diagnostics of a compilation into its result */
+typedef struct {
+    mpc_result *result;
+    size_t size;            // Diagnostics allocated.
+    int nomem;              // Set if a diagnostic couldn't be stored.
+} Collector;
+
+/*
+***************************************************************************
+*                           Internal Routines
+***************************************************************************
+*/
+
+/* Diagnostic sink (see debug.h): Appends a copy of the diagnostic to the result. */
+static void collectDiagnostic (void *arg, int isError, int line, const char *msg) {
+    Collector *c = arg;
+    mpc_result *result = c->result;
+    mpc_diagnostic *list;
+    size_t size;
+    char *message;
+
+    if (c->nomem) {
+        return;
+    }
+    if (result->diagnosticCount == c->size) {
+        size = (c->size == 0 ? MPC_DEFAULT_DIAGNOSTICS : 2 * c->size);
+        if ((list = realloc(result->diagnostics, size * sizeof(mpc_diagnostic))) == NULL) {
+            c->nomem = 1;
+            return;
+        }
+        result->diagnostics = list;
+        c->size = size;
+    }
+    if ((message = strdup(msg)) == NULL) {
+        c->nomem = 1;
+        return;
+    }
+    result->diagnostics[result->diagnosticCount++] = (mpc_diagnostic){
+        .isError = isError, .line = line, .message = message
+    };
+}
+
+/*
+***************************************************************************
+*                                Routines
+***************************************************************************
+*/
+
+/* Compiles the `len` bytes of Pascal source at `src` into `result`. Options
+ * may be NULL. Nothing is read from or written to files, and no state is
+ * shared between calls, so any number of threads may compile at once.
+ * Returns MPC_OK, MPC_FAILED or MPC_NOMEM. */
+int mpc_compile (const char *src, size_t len, const mpc_options *options, mpc_result *result) {
+    mpc_compiler *mpc;
+    int status;
+
+    if ((mpc = mpc_new(options)) == NULL) {
+        *result = (mpc_result){.code = NULL, .diagnostics = NULL, .log = NULL};
+        return MPC_NOMEM;
+    }
+    status = mpc_compile_with(mpc, src, len, result);
+    mpc_delete(mpc);
+    return status;
+}
+
+/* Returns a new compiler instance with the given options (may be NULL), or
+ * NULL if out of memory. An instance may be used by one thread at a time. */
+mpc_compiler *mpc_new (const mpc_options *options) {
+    CompileOptions o = {.debug = 0, .quiet = 0, .color = 0, .stats = 0};
+    mpc_compiler *mpc;
+
+    if ((mpc = malloc(sizeof(mpc_compiler))) == NULL) {
+        return NULL;
+    }
+    if (options != NULL) {
+        o.debug = options->listing;
+        o.quiet = options->quiet;
+        o.level = options->level;
+    }
+    initCompileContext(&mpc->ctx, &o);
+    return mpc;
+}
+
+/* As mpc_compile, on compiler instance `mpc`. The generated code is handed
+ * over to the result without copying. */
+int mpc_compile_with (mpc_compiler *mpc, const char *src, size_t len, mpc_result *result) {
+    CompileContext *ctx = &mpc->ctx;
+    Collector collector = {.result = result, .size = 0, .nomem = 0};
+    char nul = '\0';
+    FILE *fp, *errfp;
+    int failed;
+
+    *result = (mpc_result){.code = NULL, .diagnostics = NULL, .log = NULL};
+
+    // The scanner can't read an empty memory stream: Pass a lone NUL instead.
+    if (len == 0) {
+        src = &nul;
+        len = 1;
+    }
+    if ((fp = fmemopen((void *)src, len, "r")) == NULL) {
+        return MPC_NOMEM;
+    }
+    if ((errfp = open_memstream(&result->log, &result->logSize)) == NULL) {
+        fclose(fp);
+        return MPC_NOMEM;
+    }
+
+    // Compile, collecting diagnostics both as text and as a list.
+    ctx->debug.sink = collectDiagnostic;
+    ctx->debug.sinkArg = &collector;
+    failed = compileStream(ctx, fp, errfp);
+    ctx->debug.sink = NULL;
+    ctx->debug.sinkArg = NULL;
+    fclose(fp);
+    if (fclose(errfp) != 0) {
+        collector.nomem = 1;
+    }
+
+    // Take over the generated code.
+    if (!failed && !collector.nomem &&
+        (result->code = releaseIRBuffer(ctx, &result->codeSize)) == NULL) {
+        collector.nomem = 1;
+    }
+    if (collector.nomem) {
+        mpc_free_result(result);
+        return MPC_NOMEM;
+    }
+    return (failed ? MPC_FAILED : MPC_OK);
+}
+
+/* Frees a compiler instance. */
+void mpc_delete (mpc_compiler *mpc) {
+    if (mpc == NULL) {
+        return;
+    }
+    freeCompileContext(&mpc->ctx);
+    free(mpc);
+}
+
+/* Frees all buffers of a result and empties it. */
+void mpc_free_result (mpc_result *result) {
+    for (size_t i = 0; i < result->diagnosticCount; i++) {
+        free(result->diagnostics[i].message);
+    }
+    free(result->diagnostics);
+    free(result->code);
+    free(result->log);
+    *result = (mpc_result){.code = NULL, .diagnostics = NULL, .log = NULL};
+}
@@ -0,0 +1,80 @@
+#if !defined(LIBMPC_H)
+#define LIBMPC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+***************************************************************************
+*                     Mini Pascal Compiler Library                        *
+* AUTHORS: Charles Randolph, Joe Jones.                                   *
+* SNUMBERS: s2897318, s2990652.                                           *
+***************************************************************************
+*/
+
+/*
+***************************************************************************
+*                  Symbolic Constants & Type Definitions
+***************************************************************************
+*/
+
+/* Return values of mpc_compile */
+#define MPC_OK                  0       // Compiled. The code is in the result.
+#define MPC_FAILED              1       // The program has errors. No code.
+#define MPC_NOMEM               2       // Out of memory. The result is empty.
+
+/* Options of a compilation. Zero-initialized options are the defaults */
+typedef struct {
+    int quiet;              // Drops all warnings.
+    int listing;            // Writes the parsed source into the log.
+    int level;              // Optimization level of the code, as mpc -O<Level>. Zero for none.
+} mpc_options;
+
+/* A single error or warning */
+typedef struct {
+    int isError;            // Nonzero for an error, zero for a warning.
+    int line;               // Source line the diagnostic was raised on.
+    char *message;          // The message, without the source line.
+} mpc_diagnostic;
+
+/* The result of a compilation. All buffers are owned by the caller, and are
+ * freed with mpc_free_result. */
+typedef struct {
+    char *code;                         // Generated C, NUL-terminated (NULL on failure).
+    size_t codeSize;                    // Length of the code.
+    mpc_diagnostic *diagnostics;        // Errors and warnings, in order.
+    size_t diagnosticCount;             // Number of diagnostics.
+    char *log;                          // Diagnostics as printed by mpc, NUL-terminated.
+    size_t logSize;                     // Length of the log.
+} mpc_result;
+
+/* A compiler instance. It keeps its tables allocated between compilations */
+typedef struct mpcCompiler mpc_compiler;
+
+/*
+***************************************************************************
+*                           Routine Prototypes
+***************************************************************************
+*/
+
+/* Compiles the `len` bytes of Pascal source at `src` into `result`. Options
+ * may be NULL. Nothing is read from or written to files, and no state is
+ * shared between calls, so any number of threads may compile at once.
+ * Returns MPC_OK, MPC_FAILED or MPC_NOMEM. */
+int mpc_compile (const char *src, size_t len, const mpc_options *options, mpc_result *result);
+
+/* Returns a new compiler instance with the given options (may be NULL), or
+ * NULL if out of memory. An instance may be used by one thread at a time. */
+mpc_compiler *mpc_new (const mpc_options *options);
+
+/* As mpc_compile, on compiler instance `mpc`. The generated code is handed
+ * over to the result without copying. */
+int mpc_compile_with (mpc_compiler *mpc, const char *src, size_t len, mpc_result *result);
+
+/* Frees a compiler instance. */
+void mpc_delete (mpc_compiler *mpc);
+
+/* Frees all buffers of a result and empties it. */
+void mpc_free_result (mpc_result *result);
+
+#endif
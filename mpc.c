@@ -1,6 +1,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <glob.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+/* Compiler Stages */
+#include "debug.h"          // Diagnostics and mode flags.
+#include "compile.h"        // Compilation driver.
+#include "pool.h"           // Worker pool for batch mode.
+#include "server.h"         // Compile server and client.
+#include "cache.h"          // Compile cache.
+#include "stats.h"          // Compilation statistics.
 
 /*
 ***************************************************************************
@@ -10,31 +23,470 @@
 ***************************************************************************
 */
 
-#define USAGE       "./mpc <InputFile> <OutputFile>\n"
+#define USAGE       "./mpc [-c] [-d] [-q] [--stats[=json]] [--mmap] [--cache <Dir>] [--client <Socket>] <InputFile> <OutputFile>\n" \
+                    "./mpc [-c] [-d] [-q] [--stats[=json]] [--mmap] [--cache <Dir>] [-O<Level>] [--cc <Compiler>] [--cflags <Flags>] " \
+                    "-o <Program> <InputFile>\n" \
+                    "./mpc [-c] [-d] [-q] [--stats[=json]] --stream <InputFile | -> <OutputFile | ->\n" \
+                    "./mpc [-c] [-q] [--stats[=json]] [--mmap] [--cache <Dir>] --batch [-j <Workers>] <InputFile | Glob | @ListFile>...\n" \
+                    "./mpc [-c] [-q] --server <Socket> [-j <Workers>]\n" \
+                    "./mpc --cache <Dir> --cache-stats\n"
+
+/* Simple usage manual */
+#define MP_USAGE   "\nSupported Program Flags:\n \
+\t-d : Debug Mode. Outputs file while parsing.\n \
+\t-q : Quiet Mode. Surpresses all warnings.\n \
+\t-c : Color Mode. All output (and syntax) has\n \
+\t     color.\n \
+\t--batch : Batch Mode. Compiles every input to a\n \
+\t     .c file beside it, in parallel.\n \
+\t--stream : Stream Mode. Compiles the source as\n \
+\t     it arrives, writing C per statement. \"-\"\n \
+\t     names the standard input or output.\n \
+\t--server : Server Mode. Serves compile requests\n \
+\t     on the given Unix socket.\n \
+\t--client : Compiles on the server at the given\n \
+\t     Unix socket.\n \
+\t-j : Number of batch or server workers. Defaults\n \
+\t     to the number of processors.\n \
+\t-o : Native Mode. Builds the executable with the\n \
+\t     C compiler, piping it the generated C.\n \
+\t-O0 .. -O3 : Optimization level of the generated\n \
+\t     code, and of native builds. Defaults to -O2.\n \
+\t--cc : C compiler of native builds. Defaults to\n \
+\t     $CC, or cc.\n \
+\t--cflags : Extra C compiler flags.\n \
+\t--stats : Reports time per compiler phase, peak\n \
+\t     memory and table sizes. --stats=json for JSON.\n \
+\t--mmap : Mapped Mode. Memory-maps source files\n \
+\t     rather than reading them.\n \
+\t--cache : Reuses the output of unchanged sources\n \
+\t     from the given cache directory.\n \
+\t--cache-size : Bound on the cache size in MiB.\n \
+\t     Defaults to 64.\n \
+\t--cache-stats : Prints cache statistics.\n\n"
+
+/* Options of every compilation: Debug, quiet, color and statistics modes, and optimization level */
+static CompileOptions options = {.level = MPC_DEFAULT_LEVEL};
+
+/* Batch mode flag and worker count (zero selects all processors) */
+static int inBatch;
+static unsigned workers;
+
+/* Stream mode flag */
+static int inStream;
+
+/* Socket of the compile server to run (server mode) or use (client mode) */
+static const char *serverPath, *clientPath;
+
+/* Executable of a native build (NULL if generating C) and its settings */
+static const char *nativePath;
+static NativeOptions native = {.cc = NULL, .flags = "", .level = MPC_DEFAULT_LEVEL};
+
+/* Compile cache directory, size bound and statistics flag */
+static const char *cachePath;
+static size_t cacheLimit = CACHE_DEFAULT_LIMIT;
+static int inCacheStats;
+
+/* A batch compilation job */
+typedef struct {
+    char *in, *out;         // Source file and generated C file.
+    int failed;             // Nonzero if compilation failed.
+    double ms;              // Wall-clock time of the compilation.
+    char *diag;             // Diagnostics written during compilation.
+    size_t diagSize;        // Length of diagnostics.
+} BatchJob;
+
+/* The list of batch jobs */
+typedef struct {
+    unsigned length;
+    BatchJob *list;
+} BatchList;
+
+/*
+***************************************************************************
+*                           Internal Routines
+***************************************************************************
+*/
+
+/* Returns the monotonic wall-clock time in milliseconds. */
+static double wallTime (void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
 
-#define MAXLINE     1000
+/* Parses program flags. Returns the index of the first non-flag argument.
+ * Supported flags:
+ * -c : Color Mode. Semantic Analysis output is color-formatted.
+ * -d : Debug Mode. Outputs lines as they are parsed. Useful for syntax errors.
+ * -q : Quiet Mode. Disabled all warnings.
+ * --batch : Batch Mode. Compiles all inputs in parallel.
+ * --stream : Stream Mode. Compiles the source as it arrives.
+ * --server <path> : Server Mode. Serves compile requests on a Unix socket.
+ * --client <path> : Client Mode. Compiles on the server at a Unix socket.
+ * -j <n> : Number of batch or server workers.
+ * -o <path> : Native Mode. Builds an executable with the C compiler.
+ * -O<n> : Optimization level of the generated code and of native builds (0-3).
+ * --cc <cmd> : C compiler of native builds.
+ * --cflags <flags> : Extra C compiler flags of native builds.
+ * --stats[=json] : Reports statistics of each compilation as text or JSON.
+ * --mmap : Mapped Mode. Source files are memory-mapped.
+ * --cache <dir> : Compile cache directory.
+ * --cache-size <MiB> : Bound on the cache size.
+ * --cache-stats : Prints cache statistics.
+ */
+static int parseArguments (int argc, const char *argv[]) {
+    int i;
 
-char line[MAXLINE];
+    for (i = 1; i < argc && *argv[i] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "--batch") == 0) {
+            inBatch = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--stream") == 0) {
+            inStream = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--server") == 0 || strcmp(argv[i], "--client") == 0) {
+            if (i + 1 == argc) {
+                fprintf(stderr, "Expected a socket path after \"%s\"!\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+            *(argv[i][2] == 's' ? &serverPath : &clientPath) = argv[i + 1];
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--cc") == 0 || strcmp(argv[i], "--cflags") == 0) {
+            if (i + 1 == argc) {
+                fprintf(stderr, "Expected an argument after \"%s\"!\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+            *(argv[i][3] == 'f' ? &native.flags : &native.cc) = argv[i + 1];
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--cache") == 0) {
+            if (++i == argc) {
+                fprintf(stderr, "Expected a directory after \"--cache\"!\n");
+                exit(EXIT_FAILURE);
+            }
+            cachePath = argv[i];
+            continue;
+        }
+        if (strcmp(argv[i], "--cache-size") == 0) {
+            if (++i == argc || atoi(argv[i]) <= 0) {
+                fprintf(stderr, "Expected a positive size after \"--cache-size\"!\n");
+                exit(EXIT_FAILURE);
+            }
+            cacheLimit = (size_t)atoi(argv[i]) << 20;
+            continue;
+        }
+        if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=json") == 0) {
+            options.stats = (argv[i][7] == '=' ? STATS_JSON : STATS_TEXT);
+            continue;
+        }
+        if (strcmp(argv[i], "--mmap") == 0) {
+            options.mapped = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--cache-stats") == 0) {
+            inCacheStats = 1;
+            continue;
+        }
+        switch (argv[i][1]) {
+            case 'c':
+                options.color = 1;
+                break;
+            case 'd':
+                options.debug = 1;
+                break;
+            case 'h':
+                fprintf(stdout, MP_USAGE);
+                break;
+            case 'j':
+                if (++i == argc || (workers = atoi(argv[i])) == 0) {
+                    fprintf(stderr, "Expected a positive worker count after \"-j\"!\n");
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'o':
+                if (++i == argc) {
+                    fprintf(stderr, "Expected a program name after \"-o\"!\n");
+                    exit(EXIT_FAILURE);
+                }
+                nativePath = argv[i];
+                break;
+            case 'O':
+                if (argv[i][2] < '0' || argv[i][2] > '3' || argv[i][3] != '\0') {
+                    fprintf(stderr, "Expected an optimization level -O0 to -O3, not \"%s\"!\n", argv[i]);
+                    exit(EXIT_FAILURE);
+                }
+                options.level = native.level = argv[i][2] - '0';
+                break;
+            case 'q':
+                options.quiet = 1;
+                break;
+            default:
+                fprintf(stderr, "Unknown argument \"%s\"!\n", argv[i]);
+                fprintf(stderr, "%s", MP_USAGE);
+                exit(EXIT_FAILURE);
+        }
+    }
+    return i;
+}
+
+/*
+***************************************************************************
+*                           Batch Mode Routines
+***************************************************************************
+*/
+
+/* Appends a job for source file `in`. The output replaces a .pas suffix with .c */
+static void addBatchJob (BatchList *batch, const char *in) {
+    size_t n = strlen(in);
+    BatchJob *job;
+
+    if ((batch->list = realloc(batch->list, (batch->length + 1) * sizeof(BatchJob))) == NULL) {
+        fprintf(stderr, "Error: addBatchJob: List reallocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    job = memset(&batch->list[batch->length++], 0, sizeof(BatchJob));
+
+    if (n > 4 && strcmp(in + n - 4, ".pas") == 0) {
+        n -= 4;
+    }
+    if ((job->in = strdup(in)) == NULL || (job->out = malloc(n + 3)) == NULL) {
+        fprintf(stderr, "Error: addBatchJob: Couldn't allocate file names!\n");
+        exit(EXIT_FAILURE);
+    }
+    sprintf(job->out, "%.*s.c", (int)n, in);
+}
+
+/* Appends jobs for all files matching the glob pattern. Patterns without
+ * matches are kept as-is, so that missing files are reported. */
+static void addBatchPattern (BatchList *batch, const char *pattern) {
+    glob_t g;
+    if (glob(pattern, GLOB_NOCHECK, NULL, &g) != 0) {
+        fprintf(stderr, "Error: addBatchPattern: Couldn't expand \"%s\"!\n", pattern);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < g.gl_pathc; i++) {
+        addBatchJob(batch, g.gl_pathv[i]);
+    }
+    globfree(&g);
+}
+
+/* Appends jobs for an argument: A file, a glob pattern, or @file listing
+ * one file or pattern per line. */
+static void addBatchArgument (BatchList *batch, const char *arg) {
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t n;
+    FILE *fp;
+
+    if (*arg != '@') {
+        addBatchPattern(batch, arg);
+        return;
+    }
+    if ((fp = fopen(arg + 1, "r")) == NULL) {
+        fprintf(stderr, "mpc: Couldn't open list \"%s\"!\n", arg + 1);
+        exit(EXIT_FAILURE);
+    }
+    while ((n = getline(&line, &size, fp)) != -1) {
+        while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r')) {
+            line[--n] = '\0';
+        }
+        if (n > 0) {
+            addBatchPattern(batch, line);
+        }
+    }
+    free(line);
+    fclose(fp);
+}
+
+/* Pool job: Compiles one batch entry, capturing its diagnostics. */
+static void runBatchJob (unsigned i, void *arg) {
+    BatchJob *job = &((BatchList *)arg)->list[i];
+    CompileContext ctx;
+    FILE *errfp;
+    double start = wallTime();
+
+    if ((errfp = open_memstream(&job->diag, &job->diagSize)) == NULL) {
+        fprintf(stderr, "Error: runBatchJob: Couldn't allocate diagnostics buffer!\n");
+        exit(EXIT_FAILURE);
+    }
+    initCompileContext(&ctx, &options);
+    job->failed = compileFile(&ctx, job->in, job->out, NULL, errfp);
+    if (options.stats) {
+        printStats(&ctx, errfp, job->in);
+    }
+    freeCompileContext(&ctx);
+    fclose(errfp);
+    job->ms = wallTime() - start;
+}
+
+/* Compiles all batch inputs in parallel. Reports status per file in input
+ * order followed by aggregate timing. Returns nonzero if any failed. */
+static int runBatch (int argc, const char *argv[]) {
+    BatchList batch = {.length = 0, .list = NULL};
+    struct rusage usage;
+    unsigned failed = 0;
+    double start, wall, sum = 0.0;
+
+    for (int i = 0; i < argc; i++) {
+        addBatchArgument(&batch, argv[i]);
+    }
+    if (workers == 0) {
+        workers = processorCount();
+    }
+    if (workers > batch.length && batch.length > 0) {
+        workers = batch.length;
+    }
+
+    start = wallTime();
+    runPool(batch.length, workers, runBatchJob, &batch);
+    wall = wallTime() - start;
+
+    for (unsigned i = 0; i < batch.length; i++) {
+        BatchJob *job = &batch.list[i];
+        fprintf(stdout, "%-4s %s (%.2f ms)\n", job->failed ? "FAIL" : "ok", job->in, job->ms);
+        fwrite(job->diag, 1, job->diagSize, stdout);
+        failed += (job->failed != 0);
+        sum += job->ms;
+        free(job->diag);
+        free(job->in);
+        free(job->out);
+    }
+    free(batch.list);
+
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(stdout, "%u files: %u ok, %u failed. Workers: %u, %.2f ms wall, %.2f ms compiling, "
+        "%.2f ms cpu.\n", batch.length, batch.length - failed, failed, workers, wall, sum,
+        usage.ru_utime.tv_sec * 1e3 + usage.ru_utime.tv_usec / 1e3 +
+        usage.ru_stime.tv_sec * 1e3 + usage.ru_stime.tv_usec / 1e3);
+
+    return (failed != 0);
+}
+
+/*
+***************************************************************************
+*                           Stream Mode Routines
+***************************************************************************
+*/
+
+/* Compiles `in` into `out` as the source arrives, "-" naming the standard
+ * input or output. A partially written output file is removed on failure.
+ * Returns nonzero on failure. */
+static int runStream (CompileContext *ctx, const char *in, const char *out) {
+    int infd = STDIN_FILENO, outfd = STDOUT_FILENO, failed;
+
+    if (strcmp(in, "-") != 0 && (infd = open(in, O_RDONLY)) < 0) {
+        fprintf(stderr, "mpc: Couldn't open \"%s\"!\n", in);
+        return 1;
+    }
+    if (strcmp(out, "-") != 0 && (outfd = open(out, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+        fprintf(stderr, "mpc: Couldn't write \"%s\"!\n", out);
+        if (infd != STDIN_FILENO) {
+            close(infd);
+        }
+        return 1;
+    }
+    if ((failed = compileFd(ctx, infd, outfd, stderr)) != 0) {
+        fprintf(stderr, "mpc: Compilation of \"%s\" failed at semantic stage!\n", in);
+    }
+    if (outfd != STDOUT_FILENO) {
+        close(outfd);
+        if (failed) {
+            unlink(out);
+        }
+    }
+    if (infd != STDIN_FILENO) {
+        close(infd);
+    }
+    return failed;
+}
 
 int main (int argc, const char *argv[]) {
+    int i = parseArguments(argc, argv), failed;
+    CompileContext ctx;
 
-    /* Verify correct number of arguments are provided. */
-    if (argc != 3) {
-        fprintf(stderr, USAGE);
+    /* Open the cache, if any. Statistics need nothing more. */
+    if (cachePath != NULL && openCache(cachePath, cacheLimit)) {
         return EXIT_FAILURE;
     }
+    if (inCacheStats) {
+        if (!cacheEnabled()) {
+            fprintf(stderr, "Expected a cache directory (\"--cache <Dir>\")!\n");
+            return EXIT_FAILURE;
+        }
+        printCacheStats(stdout);
+        return EXIT_SUCCESS;
+    }
+
+    /* Server mode: Runs until terminated. */
+    if (serverPath != NULL) {
+        return runServer(serverPath, &options, (workers == 0 ? processorCount() : workers));
+    }
 
-    /* Perform Semantic Analysis: Remove the "-c" flag to disable color */
-    sprintf(line, "./frontend/a.out -c < %s", argv[1]);
-    int verifiedSemantics = system(line);
+    if (inStream) {
 
-    /* If successful, generate IR code. */
-    if (verifiedSemantics == EXIT_SUCCESS) {
-        sprintf(line, "./backend/a.out %s < %s", argv[2], argv[1]);
-        system(line);
+        /* Stream mode: A single input and output. Statistics go to stderr
+         * if the output is written to stdout. */
+        if (argc - i != 2 || inBatch || nativePath != NULL || clientPath != NULL) {
+            fprintf(stderr, USAGE);
+            return EXIT_FAILURE;
+        }
+        initCompileContext(&ctx, &options);
+        failed = runStream(&ctx, argv[i], argv[i + 1]);
+        if (options.stats) {
+            printStats(&ctx, (strcmp(argv[i + 1], "-") == 0 ? stderr : stdout), argv[i]);
+        }
+        freeCompileContext(&ctx);
+    } else if (nativePath != NULL) {
+
+        /* Native mode: A single input, built into the program. */
+        if (argc - i != 1 || inBatch || clientPath != NULL) {
+            fprintf(stderr, USAGE);
+            return EXIT_FAILURE;
+        }
+        if (native.cc == NULL && (native.cc = getenv("CC")) == NULL) {
+            native.cc = MPC_DEFAULT_CC;
+        }
+        initCompileContext(&ctx, &options);
+        failed = compileFile(&ctx, argv[i], nativePath, &native, stderr);
+        if (options.stats) {
+            printStats(&ctx, stdout, argv[i]);
+        }
+        freeCompileContext(&ctx);
+    } else if (inBatch) {
+
+        /* Batch mode: All remaining arguments are inputs. */
+        if (i == argc) {
+            fprintf(stderr, USAGE);
+            return EXIT_FAILURE;
+        }
+        failed = runBatch(argc - i, argv + i);
     } else {
-        fprintf(stderr, "mpc: Compilation failed at semantic stage!\n");
+
+        /* Verify correct number of arguments are provided. */
+        if (argc - i != 2) {
+            fprintf(stderr, USAGE);
+            return EXIT_FAILURE;
+        }
+
+        /* Client mode: Compile on the server. Otherwise compile here. */
+        if (clientPath != NULL) {
+            failed = runClient(clientPath, argv[i], argv[i + 1]);
+        } else {
+            initCompileContext(&ctx, &options);
+            failed = compileFile(&ctx, argv[i], argv[i + 1], NULL, stderr);
+            if (options.stats) {
+                printStats(&ctx, stdout, argv[i]);
+            }
+            freeCompileContext(&ctx);
+        }
     }
 
-    return 0;
-}
\ No newline at end of file
+    closeCache();
+    return (failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
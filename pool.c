@@ -0,0 +1,139 @@
+#include <pthread.h>
+#include <unistd.h>
+#include "pool.h"
+
+/*
+***************************************************************************
+*                  Internal Data Structures & Variables
+***************************************************************************
+*/
+
+/* Deque of job indices. The owner pops at the tail, thieves at the head. */
+typedef struct {
+    pthread_mutex_t lock;
+    unsigned head, tail;        // Remaining jobs are [head, tail).
+} Deque;
+
+/* Shared state of a running pool. */
+typedef struct {
+    Deque *deques;
+    unsigned workers;
+    void (*job)(unsigned, void *);
+    void *arg;
+} Pool;
+
+/* Argument of a worker thread. */
+typedef struct {
+    Pool *pool;
+    unsigned self;
+} Worker;
+
+/*
+***************************************************************************
+*                           Internal Routines
+***************************************************************************
+*/
+
+/* Pops a job from the tail of the deque. Returns nonzero if one was taken. */
+static int popJob (Deque *d, unsigned *i) {
+    int taken = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->head < d->tail) {
+        *i = --d->tail;
+        taken = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return taken;
+}
+
+/* Steals a job from the head of the deque. Returns nonzero if one was taken. */
+static int stealJob (Deque *d, unsigned *i) {
+    int taken = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->head < d->tail) {
+        *i = d->head++;
+        taken = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return taken;
+}
+
+/* Worker thread: Drains its own deque, then steals until all are empty.
+ * Jobs never create jobs, so empty deques remain empty. */
+static void *work (void *arg) {
+    Worker *w = arg;
+    Pool *p = w->pool;
+    unsigned i = 0, k;
+
+    for (;;) {
+        if (popJob(&p->deques[w->self], &i)) {
+            p->job(i, p->arg);
+            continue;
+        }
+        for (k = 1; k < p->workers; k++) {
+            if (stealJob(&p->deques[(w->self + k) % p->workers], &i)) {
+                break;
+            }
+        }
+        if (k == p->workers) {
+            return NULL;
+        }
+        p->job(i, p->arg);
+    }
+}
+
+/*
+***************************************************************************
+*                                Routines
+***************************************************************************
+*/
+
+/* Returns the number of online processors. At least one. */
+unsigned processorCount (void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0 ? (unsigned)n : 1);
+}
+
+/* Runs job(i, arg) for every i in [0, n) on `workers` threads. Each worker
+ * owns a deque holding a contiguous block of jobs, which it works through
+ * from the back. Idle workers steal from the front of the other deques.
+ * Returns once all jobs have completed. */
+void runPool (unsigned n, unsigned workers, void (*job)(unsigned, void *), void *arg) {
+    pthread_t *threads;
+    Worker *ws;
+    Pool p = {.workers = (workers == 0 ? 1 : workers), .job = job, .arg = arg};
+
+    if ((p.deques = malloc(p.workers * sizeof(Deque))) == NULL ||
+        (threads = malloc(p.workers * sizeof(pthread_t))) == NULL ||
+        (ws = malloc(p.workers * sizeof(Worker))) == NULL) {
+        fprintf(stderr, "Error: runPool: Couldn't allocate pool!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Deal out contiguous blocks of jobs.
+    for (unsigned k = 0; k < p.workers; k++) {
+        pthread_mutex_init(&p.deques[k].lock, NULL);
+        p.deques[k].head = (unsigned)((unsigned long long)n * k / p.workers);
+        p.deques[k].tail = (unsigned)((unsigned long long)n * (k + 1) / p.workers);
+        ws[k] = (Worker){.pool = &p, .self = k};
+    }
+
+    // Start workers. The calling thread acts as worker zero.
+    for (unsigned k = 1; k < p.workers; k++) {
+        if (pthread_create(&threads[k], NULL, work, &ws[k]) != 0) {
+            fprintf(stderr, "Error: runPool: Couldn't start worker %u!\n", k);
+            exit(EXIT_FAILURE);
+        }
+    }
+    work(&ws[0]);
+    for (unsigned k = 1; k < p.workers; k++) {
+        pthread_join(threads[k], NULL);
+    }
+
+    for (unsigned k = 0; k < p.workers; k++) {
+        pthread_mutex_destroy(&p.deques[k].lock);
+    }
+    free(ws);
+    free(threads);
+    free(p.deques);
+}
@@ -0,0 +1,30 @@
+#if !defined(POOL_H)
+#define POOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+***************************************************************************
+*                         Work-Stealing Worker Pool                       *
+* AUTHORS: Charles Randolph, Joe Jones.                                   *
+* SNUMBERS: s2897318, s2990652.                                           *
+***************************************************************************
+*/
+
+/*
+***************************************************************************
+*                           Routine Prototypes
+***************************************************************************
+*/
+
+/* Returns the number of online processors. At least one. */
+unsigned processorCount (void);
+
+/* Runs job(i, arg) for every i in [0, n) on `workers` threads. Each worker
+ * owns a deque holding a contiguous block of jobs, which it works through
+ * from the back. Idle workers steal from the front of the other deques.
+ * Returns once all jobs have completed. */
+void runPool (unsigned n, unsigned workers, void (*job)(unsigned, void *), void *arg);
+
+#endif
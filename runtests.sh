@@ -1,41 +1,68 @@
 echo Running alt.pas
-frontend/a.out -c < Tests/alt.pas
+./mpc -c Tests/alt.pas /dev/null
 
 echo Running calc.pas
-frontend/a.out -c < Tests/calc.pas
+./mpc -c Tests/calc.pas /dev/null
 
 echo Running count.pas
-frontend/a.out -c < Tests/count.pas
+./mpc -c Tests/count.pas /dev/null
 
 echo Running fibonacci.pas
-frontend/a.out -c < Tests/fibonacci.pas
+./mpc -c Tests/fibonacci.pas /dev/null
 
 echo Running funcproc.pas
-frontend/a.out -c < Tests/funcproc.pas
+./mpc -c Tests/funcproc.pas /dev/null
 
 echo Running gcd.pas
-frontend/a.out -c < Tests/gcd.pas
+./mpc -c Tests/gcd.pas /dev/null
 
 echo Running longexp.pas
-frontend/a.out -c < Tests/longexp.pas
+./mpc -c Tests/longexp.pas /dev/null
 
 echo Running missing.pas
-frontend/a.out -c < Tests/missing.pas
+./mpc -c Tests/missing.pas /dev/null
 
 echo Running permutations.pas
-frontend/a.out -c < Tests/permutations.pas
+./mpc -c Tests/permutations.pas /dev/null
 
 echo Running prime.pas
-frontend/a.out -c < Tests/prime.pas
+./mpc -c Tests/prime.pas /dev/null
 
 echo Running puzzle.pas
-frontend/a.out -c < Tests/puzzle.pas
+./mpc -c Tests/puzzle.pas /dev/null
 
 echo Running pyth.pas
-frontend/a.out -c < Tests/pyth.pas
+./mpc -c Tests/pyth.pas /dev/null
 
 echo Running sign.pas
-frontend/a.out -c < Tests/sign.pas
+./mpc -c Tests/sign.pas /dev/null
 
 echo Running sumsproducts.pas
-frontend/a.out -c < Tests/sumsproducts.pas
+./mpc -c Tests/sumsproducts.pas /dev/null
+
+# The optimizer must not change what a program does: Build each sample that
+# compiles at -O0 and at -O2, run both on the same input and compare.
+echo Comparing -O0 and -O2 output
+dir=$(mktemp -d)
+failed=0
+for f in Tests/*.pas; do
+    name=$(basename $f .pas)
+    ./mpc -q -O0 $f $dir/$name.O0.c > /dev/null 2>&1 || continue
+    echo Comparing $name.pas
+    for level in O0 O2; do
+        ./mpc -q -$level $f $dir/$name.$level.c > /dev/null &&
+        ${CC:-cc} -w -o $dir/$name.$level $dir/$name.$level.c -lm &&
+        timeout 5 $dir/$name.$level > $dir/$name.$level.out <<INPUT
+4 7 3 12
+18 5 9 2
+6 1 8 11
+INPUT
+    done
+    if ! cmp -s $dir/$name.O0.out $dir/$name.O2.out; then
+        echo "FAILED: $name.pas prints differently at -O2"
+        diff $dir/$name.O0.out $dir/$name.O2.out
+        failed=1
+    fi
+done
+rm -rf $dir
+exit $failed
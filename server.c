@@ -0,0 +1,277 @@
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include "server.h"
+#include "compile.h"
+#include "mpio.h"
+
+/*
+***************************************************************************
+*                  Internal Symbolic Constants & Variables
+***************************************************************************
+*/
+
+/* Size of the chunks read from a socket */
+#define SERVER_CHUNK            4096
+
+/* Seconds a worker waits before accepting again when out of file descriptors or memory */
+#define SERVER_BACKOFF          1
+
+/* Growable byte buffer */
+typedef struct {
+    char *data;
+    size_t length, size;
+} Buffer;
+
+/* The listening socket and the options of every compilation, shared by all workers */
+typedef struct {
+    int fd;
+    const CompileOptions *options;
+} Listener;
+
+/*
+***************************************************************************
+*                           Internal Routines
+***************************************************************************
+*/
+
+/* Fills `addr` with the Unix socket address for `path`. Returns nonzero if too long. */
+static int socketAddress (const char *path, struct sockaddr_un *addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "mpc: Socket path \"%s\" is too long!\n", path);
+        return 1;
+    }
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+
+/* Reads from `fd` until end-of-file into the buffer. The buffer always keeps
+ * free space after the data. Returns nonzero on error. */
+static int readAll (int fd, Buffer *b) {
+    ssize_t n;
+    do {
+        if (b->size - b->length < SERVER_CHUNK) {
+            b->size = 2 * b->size + SERVER_CHUNK;
+            if ((b->data = realloc(b->data, b->size)) == NULL) {
+                fprintf(stderr, "Error: readAll: Buffer reallocation failed!\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        if ((n = read(fd, b->data + b->length, b->size - b->length)) < 0) {
+            return 1;
+        }
+        b->length += n;
+    } while (n > 0);
+    return 0;
+}
+
+/* Writes all `n` bytes of `data` to `fd`. Returns nonzero on error. */
+static int writeAll (int fd, const char *data, size_t n) {
+    ssize_t w;
+    while (n > 0) {
+        if ((w = write(fd, data, n)) < 0) {
+            return 1;
+        }
+        data += w;
+        n -= w;
+    }
+    return 0;
+}
+
+/* Handles a single compile request on connection `fd`. */
+static void serveRequest (CompileContext *ctx, int fd, Buffer *source) {
+    char header[64], *diag = NULL;
+    const char *code = "";
+    size_t diagSize = 0, codeSize = 0;
+    FILE *fp, *errfp;
+    int failed;
+
+    source->length = 0;
+    if (readAll(fd, source)) {
+        return;
+    }
+
+    // Compile the source from memory. An empty source is read as a lone NUL.
+    if (source->length == 0) {
+        source->data[source->length++] = '\0';
+    }
+    if ((fp = fmemopen(source->data, source->length, "r")) == NULL) {
+        fprintf(stderr, "Error: serveRequest: Couldn't open source buffer!\n");
+        exit(EXIT_FAILURE);
+    }
+    if ((errfp = open_memstream(&diag, &diagSize)) == NULL) {
+        fprintf(stderr, "Error: serveRequest: Couldn't allocate diagnostics buffer!\n");
+        exit(EXIT_FAILURE);
+    }
+    if ((failed = compileStream(ctx, fp, errfp)) == 0 && (code = getIRBuffer(ctx, &codeSize)) == NULL) {
+        fprintf(errfp, "mpc: Couldn't read generated code!\n");
+        failed = 1;
+    }
+    if (failed) {
+        code = "";
+        codeSize = 0;
+    }
+    fclose(errfp);
+    fclose(fp);
+
+    // Reply. A client which went away is simply dropped.
+    snprintf(header, sizeof(header), SERVER_HEADER_FORMAT, failed, codeSize, diagSize);
+    if (writeAll(fd, header, strlen(header)) == 0 && writeAll(fd, code, codeSize) == 0) {
+        writeAll(fd, diag, diagSize);
+    }
+    free(diag);
+}
+
+/* Server worker thread: Accepts and serves connections on the listening socket.
+ * Each worker compiles on its own context. */
+static void *serve (void *arg) {
+    Listener *listener = arg;
+    Buffer source = {.data = NULL, .length = 0, .size = 0};
+    CompileContext ctx;
+    int fd;
+
+    initCompileContext(&ctx, listener->options);
+    for (;;) {
+        if ((fd = accept(listener->fd, NULL, NULL)) < 0) {
+            // Interrupted, or the client went away before it was accepted.
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            // Out of resources: Wait for connections being served to release some.
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                fprintf(stderr, "mpc: Couldn't accept connection (%s), retrying!\n", strerror(errno));
+                sleep(SERVER_BACKOFF);
+                continue;
+            }
+            fprintf(stderr, "Error: serve: Couldn't accept connection (%s)!\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        serveRequest(&ctx, fd, &source);
+        close(fd);
+    }
+    return NULL;
+}
+
+/*
+***************************************************************************
+*                                Routines
+***************************************************************************
+*/
+
+/* Serves compile requests on the Unix domain socket at `path`, compiling with
+ * the given options. Requests are handled by `workers` threads, each keeping
+ * its compilation context warm between requests. Only returns (nonzero) if
+ * the socket can't be set up. */
+int runServer (const char *path, const CompileOptions *options, unsigned workers) {
+    struct sockaddr_un addr;
+    pthread_t thread;
+    Listener listener = {.options = options};
+
+    if (socketAddress(path, &addr)) {
+        return 1;
+    }
+    if ((listener.fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        fprintf(stderr, "mpc: Couldn't create socket!\n");
+        return 1;
+    }
+    unlink(path);
+    if (bind(listener.fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || 
+        listen(listener.fd, SERVER_BACKLOG) < 0) {
+        fprintf(stderr, "mpc: Couldn't listen on \"%s\"!\n", path);
+        close(listener.fd);
+        return 1;
+    }
+
+    // Clients which disconnect early must not terminate the server.
+    signal(SIGPIPE, SIG_IGN);
+
+    // The calling thread acts as the last worker.
+    for (unsigned k = 1; k < workers; k++) {
+        if (pthread_create(&thread, NULL, serve, &listener) != 0) {
+            fprintf(stderr, "Error: runServer: Couldn't start worker %u!\n", k);
+            exit(EXIT_FAILURE);
+        }
+        pthread_detach(thread);
+    }
+    serve(&listener);
+    return 0;
+}
+
+/* Compiles the source file `in` on the server listening at `path`. The
+ * generated C is written to `out`, diagnostics to stderr. Returns nonzero 
+ * on failure. */
+int runClient (const char *path, const char *in, const char *out) {
+    struct sockaddr_un addr;
+    Buffer b = {.data = NULL, .length = 0, .size = 0};
+    size_t codeSize, diagSize;
+    char *body;
+    int fd, failed = 1, sent, valid = 0, written, regular;
+    struct stat st;
+    FILE *fp;
+
+    if (socketAddress(path, &addr)) {
+        return 1;
+    }
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 || 
+        connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "mpc: Couldn't connect to \"%s\"!\n", path);
+        return 1;
+    }
+
+    // Send the source file, then receive the complete reply.
+    if ((fp = fopen(in, "r")) == NULL) {
+        fprintf(stderr, "mpc: Couldn't open \"%s\"!\n", in);
+        close(fd);
+        return 1;
+    }
+    sent = (readAll(fileno(fp), &b) == 0 && writeAll(fd, b.data, b.length) == 0);
+    fclose(fp);
+    shutdown(fd, SHUT_WR);
+
+    // Verify the header. Buffers always have room for a terminating NUL.
+    b.length = 0;
+    if (sent && readAll(fd, &b) == 0) {
+        b.data[b.length] = '\0';
+        if (sscanf(b.data, SERVER_HEADER_FORMAT, &failed, &codeSize, &diagSize) == 3 &&
+            (body = strchr(b.data, '\n')) != NULL) {
+            body++;
+            valid = (body + codeSize + diagSize == b.data + b.length);
+        }
+    }
+
+    if (!valid) {
+        fprintf(stderr, "mpc: Malformed reply from \"%s\"!\n", path);
+        failed = 1;
+    } else {
+        fwrite(body + codeSize, 1, diagSize, stderr);
+        if (failed) {
+            fprintf(stderr, "mpc: Compilation of \"%s\" failed at semantic stage!\n", in);
+        } else if ((fp = fopen(out, "w")) == NULL) {
+            fprintf(stderr, "mpc: Couldn't write \"%s\"!\n", out);
+            failed = 1;
+        } else {
+            // The file is closed either way. A partial file is removed, but never a device.
+            written = (fwrite(body, 1, codeSize, fp) == codeSize);
+            regular = (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode));
+            if (fclose(fp) != 0 || !written) {
+                fprintf(stderr, "mpc: Couldn't write \"%s\"!\n", out);
+                if (regular) {
+                    remove(out);
+                }
+                failed = 1;
+            }
+        }
+    }
+
+    free(b.data);
+    close(fd);
+    return failed;
+}
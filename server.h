@@ -0,0 +1,49 @@
+#if !defined(SERVER_H)
+#define SERVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "context.h"        // Compilation context.
+
+/*
+***************************************************************************
+*                     Compile Server over a Unix Socket                   *
+* AUTHORS: Charles Randolph, Joe Jones.                                   *
+* SNUMBERS: s2897318, s2990652.                                           *
+***************************************************************************
+*/
+
+/*
+***************************************************************************
+*                  Symbolic Constants & Global Variables
+***************************************************************************
+*/
+
+/* Protocol: A client connects, writes the Pascal source and shuts down its
+ * writing side. The server replies with a header line followed by the 
+ * generated C and the diagnostics:
+ *   "<status> <C length> <diagnostics length>\n" <C bytes> <diagnostic bytes>
+ * A nonzero status means compilation failed (no C is sent). */
+#define SERVER_HEADER_FORMAT    "%d %zu %zu\n"
+
+/* Number of pending connections the server queues */
+#define SERVER_BACKLOG          64
+
+/*
+***************************************************************************
+*                           Routine Prototypes
+***************************************************************************
+*/
+
+/* Serves compile requests on the Unix domain socket at `path`, compiling with
+ * the given options. Requests are handled by `workers` threads, each keeping
+ * its compilation context warm between requests. Only returns (nonzero) if
+ * the socket can't be set up. */
+int runServer (const char *path, const CompileOptions *options, unsigned workers);
+
+/* Compiles the source file `in` on the server listening at `path`. The
+ * generated C is written to `out`, diagnostics to stderr. Returns nonzero 
+ * on failure. */
+int runClient (const char *path, const char *in, const char *out);
+
+#endif